@@ -87,8 +87,10 @@ def setCPUClass(options):
         TmpClass = AtomicSimpleCPU
         test_mem_mode = 'atomic'
 
-    # Ruby only supports atomic accesses in noncaching mode
-    if test_mem_mode == 'atomic' and options.ruby:
+    # Ruby only supports atomic accesses in noncaching mode, unless they
+    # are used to warm up its caches
+    if test_mem_mode == 'atomic' and options.ruby and \
+            not getattr(options, 'ruby_atomic_warmup', False):
         warn("Memory mode will be changed to atomic_noncaching")
         test_mem_mode = 'atomic_noncaching'
 
@@ -0,0 +1,77 @@
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Replay a branch trace through several branch predictors without
+# simulating a CPU. Each predictor is evaluated on its own host thread.
+#
+# A trace is recorded by attaching a BranchTraceRecorder to the branch
+# predictor of a CPU, e.g. in se.py:
+#
+#   cpu.branchPred.tracer = BranchTraceRecorder(manager=cpu.branchPred)
+#
+# and is written to m5out/branches.trc.gz. Replay it with:
+#
+#   gem5.opt configs/example/bpred_replay.py m5out/branches.trc.gz \
+#       --predictors LTAGE TAGE_SC_L_64KB MultiperspectivePerceptron64KB
+#
+# The mispredictions of every predictor are in the replayer's stats,
+# next to each predictor's own stats.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import argparse
+
+import m5
+from m5.util import fatal
+from m5.objects import *
+
+parser = argparse.ArgumentParser(
+    description="Replay a branch trace through branch predictors")
+parser.add_argument("trace", help="Branch trace to replay")
+parser.add_argument("--predictors", nargs="+", default=["LTAGE"],
+                    metavar="CLASS",
+                    help="BranchPredictor classes to evaluate "
+                    "(default: %(default)s)")
+parser.add_argument("--threads", type=int, default=0,
+                    help="Number of host threads, 0 for one per predictor")
+args = parser.parse_args()
+
+predictors = []
+for cls_name in args.predictors:
+    cls = getattr(m5.objects, cls_name, None)
+    if cls is None or not issubclass(cls, BranchPredictor):
+        fatal("%s is not a branch predictor" % cls_name)
+    predictors.append(cls())
+
+root = Root(full_system=False)
+root.replayer = BranchTraceReplayer(traceFile=args.trace,
+                                    predictors=predictors,
+                                    hostThreads=args.threads)
+
+m5.instantiate()
+exit_event = m5.simulate()
+print("Exiting @ tick %i because %s" % (m5.curTick(), exit_event.getCause()))
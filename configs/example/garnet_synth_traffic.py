@@ -39,6 +39,7 @@ addToPath('../')
 
 from common import Options
 from ruby import Ruby
+from network import Network
 
 # Get paths we might need.  It's expected this file is in m5/configs/example.
 config_path = os.path.dirname(os.path.abspath(__file__))
@@ -64,7 +65,7 @@ parser.add_option("--precision", type="int", default=3,
                         for injection rate")
 
 parser.add_option("--sim-cycles", type="int", default=1000,
-                   help="Number of simulation cycles")
+                   help="Number of simulation cycles, 0 for no limit")
 
 parser.add_option("--num-packets-max", type="int", default=-1,
                   help="Stop injecting after --num-packets-max.\
@@ -83,6 +84,26 @@ parser.add_option("--inj-vnet", type="int", default=-1,
                         0 and 1 are 1-flit, 2 is 5-flit.\
                         Set to -1 to inject randomly in all vnets.")
 
+parser.add_option("--sweep-rates", type="string", default=None,
+                  help="Comma separated list of injection rates to sweep\
+                        in one simulation, in increasing order. Overrides\
+                        --injectionrate and --sim-cycles.")
+
+parser.add_option("--sweep-warmup-cycles", type="int", default=1000,
+                  help="Cycles to run each sweep point before measuring")
+
+parser.add_option("--sweep-cycles", type="int", default=10000,
+                  help="Cycles to measure each sweep point for")
+
+parser.add_option("--sweep-drain-cycles", type="int", default=100000,
+                  help="Cycles to wait for the network to drain after\
+                        each sweep point before calling it saturated")
+
+parser.add_option("--sweep-saturation-factor", type="float", default=3.0,
+                  help="A sweep point is saturated when its average\
+                        packet latency is more than this many times the\
+                        latency of the first point")
+
 #
 # Add the ruby specific and protocol specific options
 #
@@ -100,6 +121,21 @@ if options.inj_vnet > 2:
           "or 2 (5-flit) or -1 (random)" % (options.inj_vnet))
     sys.exit(1)
 
+sweep_rates = []
+if options.sweep_rates:
+    sweep_rates = [float(r) for r in options.sweep_rates.split(',')]
+    if sweep_rates != sorted(sweep_rates) or \
+       not all(0 < r <= 1 for r in sweep_rates):
+        print("Error: --sweep-rates must be increasing and between 0 and 1")
+        sys.exit(1)
+    if options.network != "garnet2.0":
+        print("Error: --sweep-rates needs --network=garnet2.0")
+        sys.exit(1)
+    # The sweep below decides when to stop, so don't let the testers
+    # end the simulation.
+    options.injectionrate = sweep_rates[0]
+    options.sim_cycles = 0
+
 
 cpus = [ GarnetSyntheticTraffic(
                      num_packets_max=options.num_packets_max,
@@ -147,10 +183,119 @@ root.system.mem_mode = 'timing'
 # Not much point in this being higher than the L1 latency
 m5.ticks.setGlobalFrequency('1ns')
 
+if options.garnet_partitions > 1:
+    root.sim_quantum = Network.partition_quantum(options)
+
 # instantiate configuration
 m5.instantiate()
 
-# simulate until program terminates
-exit_event = m5.simulate(options.abs_max_tick)
+if not sweep_rates:
+    # simulate until program terminates
+    exit_event = m5.simulate(options.abs_max_tick)
+
+    print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
+    sys.exit(0)
 
-print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
+# -----------------------
+# injection rate sweep
+# -----------------------
+#
+# Every point runs the testers at one injection rate for a warmup
+# period and a measurement period, then stops injecting until every
+# packet sent so far has arrived. Draining leaves the network empty
+# for the next point, so the points don't disturb each other. Stats
+# are reset at the start of each measurement and dumped once the
+# network has drained, giving one stats dump per point.
+#
+# Throughput and offered load are in packets per node per cycle over
+# the measurement period. Latency is the average network plus queueing
+# latency, in network cycles, of the packets received between the start
+# of the measurement and the end of the drain. A point is saturated if
+# its latency is more than --sweep-saturation-factor times that of the
+# first (lowest load) point, or if the network does not drain within
+# --sweep-drain-cycles. The sweep stops at the first saturated point.
+
+network = system.ruby.network
+cycle = system.clk_domain.clock[0].getValue()
+num_nodes = options.num_cpus
+
+def packets_sent():
+    return sum(cpu.getNumPacketsSent() for cpu in cpus)
+
+def run_cycles(cycles):
+    exit_event = m5.simulate(cycles * cycle)
+    if exit_event.getCause() != "simulate() limit reached":
+        print('Exiting @ tick', m5.curTick(), 'because',
+              exit_event.getCause())
+        sys.exit(1)
+
+def set_rate(rate):
+    for cpu in cpus:
+        cpu.setInjRate(rate)
+
+def drain():
+    sent = packets_sent()
+    waited = 0
+    chunk = 100
+    while network.getPacketsReceived() < sent:
+        if waited >= options.sweep_drain_cycles:
+            return False
+        run_cycles(chunk)
+        waited += chunk
+    return True
+
+results = []
+zero_load_latency = None
+saturation_rate = None
+for rate in sweep_rates:
+    set_rate(rate)
+    run_cycles(options.sweep_warmup_cycles)
+
+    m5.stats.reset()
+    sent_start = packets_sent()
+    received_start = network.getPacketsReceived()
+    latency_start = network.getPacketLatency()
+    run_cycles(options.sweep_cycles)
+    sent_end = packets_sent()
+    received_end = network.getPacketsReceived()
+
+    set_rate(0)
+    drained = drain()
+    m5.stats.dump()
+
+    window = float(num_nodes * options.sweep_cycles)
+    offered = (sent_end - sent_start) / window
+    accepted = (received_end - received_start) / window
+    received = network.getPacketsReceived() - received_start
+    latency = 0.0
+    if received:
+        latency = (network.getPacketLatency() - latency_start) / \
+                  float(received)
+
+    if zero_load_latency is None:
+        zero_load_latency = latency
+    saturated = not drained or \
+        latency > options.sweep_saturation_factor * zero_load_latency
+    results.append((rate, offered, accepted, latency, saturated))
+    if saturated:
+        saturation_rate = rate
+        break
+
+print()
+print("%10s %10s %10s %12s" %
+      ("inj_rate", "offered", "accepted", "avg_latency"))
+for rate, offered, accepted, latency, saturated in results:
+    print("%10.4f %10.4f %10.4f %12.2f%s" %
+          (rate, offered, accepted, latency,
+           "  saturated" if saturated else ""))
+print()
+
+if saturation_rate is None:
+    print("Network did not saturate up to injection rate", sweep_rates[-1])
+else:
+    print("Network saturates at injection rate", saturation_rate)
+    if len(results) > 1:
+        print("Saturation throughput about %.4f packets/node/cycle" %
+              results[-2][2])
+
+print('Exiting @ tick', m5.curTick(), 'because the sweep completed')
@@ -57,6 +57,7 @@ from m5.util import addToPath, fatal, warn
 addToPath('../')
 
 from ruby import Ruby
+from network import Network
 
 from common import Options
 from common import Simulation
@@ -278,4 +279,8 @@ else:
     config_filesystem(system, options)
 
 root = Root(full_system = False, system = system)
+
+if options.ruby and options.garnet_partitions > 1:
+    root.sim_quantum = Network.partition_quantum(options)
+
 Simulation.run(options, root, system, FutureClass)
@@ -30,6 +30,7 @@ from __future__ import print_function
 from __future__ import absolute_import
 
 import math
+import sys
 import m5
 from m5.objects import *
 from m5.defines import buildEnv
@@ -76,6 +77,25 @@ def define_options(parser):
     parser.add_option("--garnet-deadlock-threshold", action="store",
                       type="int", default=50000,
                       help="network-level deadlock threshold.")
+    parser.add_option("--garnet-partitions", action="store", type="int",
+                      default=1,
+                      help="""number of event queues (host threads) to
+                            spread the garnet routers over. Links between
+                            partitions act as synchronisation boundaries,
+                            so the simulation quantum is one link latency.""")
+    parser.add_option("--garnet-power-model", action="store_true",
+                      default=False,
+                      help="""attach power models to the garnet routers and
+                            links, with per-event energies from DSENT. DSENT
+                            has to be built (see
+                            util/on-chip-network-power-area.py) and gem5
+                            run from its root directory.""")
+    parser.add_option("--dsent-router-config", action="store", type="string",
+                      default="ext/dsent/configs/router.cfg",
+                      help="DSENT configuration for the garnet routers.")
+    parser.add_option("--dsent-link-config", action="store", type="string",
+                      default="ext/dsent/configs/electrical-link.cfg",
+                      help="DSENT configuration for the garnet links.")
 
 
 def create_network(options, ruby):
@@ -123,3 +143,119 @@ def init_network(options, network, InterfaceClass):
         assert(options.network == "garnet2.0")
         network.enable_fault_model = True
         network.fault_model = FaultModel()
+
+    if options.garnet_partitions > 1:
+        assert(options.network == "garnet2.0")
+        partition_network(options, network)
+
+    if options.garnet_power_model:
+        assert(options.network == "garnet2.0")
+        create_power_models(options, network)
+
+def partition_network(options, network):
+    """Spread the routers over options.garnet_partitions event queues in
+    contiguous bands of router ids, which are bands of rows for the mesh
+    topologies. Controllers and network interfaces stay on event queue 0.
+    Each link runs on the event queue of the router or interface that
+    feeds it, so only links crossing a band are shared between threads."""
+
+    num_routers = len(network.routers)
+    if options.garnet_partitions > num_routers:
+        fatal("Cannot split %d routers into %d partitions" %
+              (num_routers, options.garnet_partitions))
+
+    for router in network.routers:
+        router.eventq_index = \
+            router.router_id * options.garnet_partitions // num_routers
+
+    for link in network.int_links:
+        link.network_link.eventq_index = link.src_node.eventq_index
+        link.credit_link.eventq_index = link.dst_node.eventq_index
+
+    # network_links[0]/credit_links[0] carry flits into the router and
+    # credits back out of it, [1] the other way round.
+    for link in network.ext_links:
+        router_eq = link.int_node.eventq_index
+        link.network_links[0].eventq_index = 0
+        link.credit_links[0].eventq_index = router_eq
+        link.network_links[1].eventq_index = router_eq
+        link.credit_links[1].eventq_index = 0
+
+def create_power_models(options, network):
+    """Give every router and network link a PowerModel whose ON state is
+    a GarnetRouterPowerModel or GarnetLinkPowerModel. DSENT works out the
+    per-event energies here, and the models apply them to the activity
+    counters during the run. Credit links are only a few bits wide and
+    have no model."""
+
+    sys.path.append("build/ext/dsent")
+    try:
+        import dsent
+    except ImportError:
+        fatal("--garnet-power-model needs the DSENT python module in "
+              "build/ext/dsent, see util/on-chip-network-power-area.py")
+
+    frequency = int(m5.util.convert.anyToFrequency(options.ruby_clock))
+    buffers_per_vc = max(int(network.buffers_per_data_vc),
+                         int(network.buffers_per_ctrl_vc))
+
+    in_ports = {}
+    out_ports = {}
+    for link in network.int_links:
+        src = int(link.src_node.router_id)
+        dst = int(link.dst_node.router_id)
+        out_ports[src] = out_ports.get(src, 0) + 1
+        in_ports[dst] = in_ports.get(dst, 0) + 1
+    for link in network.ext_links:
+        router = int(link.int_node.router_id)
+        out_ports[router] = out_ports.get(router, 0) + 1
+        in_ports[router] = in_ports.get(router, 0) + 1
+
+    network.power_subsystem = SubSystem()
+
+    def off_states():
+        # CLK_GATED, SRAM_RETENTION and OFF
+        return [ MathExprPowerModel(dyn = "0", st = "0") for i in range(3) ]
+
+    dsent.initialize(options.dsent_router_config)
+    for router in network.routers:
+        rid = int(router.router_id)
+        energy = dict(dsent.computeRouterPowerAndArea(frequency,
+            in_ports.get(rid, 1), out_ports.get(rid, 1),
+            int(network.number_of_virtual_networks),
+            int(network.vcs_per_vnet), buffers_per_vc, options.link_width_bits))
+
+        router.default_p_state = "ON"
+        router.power_model = PowerModel(pm = [ GarnetRouterPowerModel(
+            buffer_read_energy = energy["Buffer read energy: "],
+            buffer_write_energy = energy["Buffer write energy: "],
+            sw_input_arbiter_energy = \
+                energy["Switch input arbiter energy: "],
+            sw_output_arbiter_energy = \
+                energy["Switch output arbiter energy: "],
+            crossbar_energy = energy["Crossbar energy: "],
+            clock_energy = energy["Clock energy: "],
+            static_power = energy["Static power: "]) ] + off_states())
+    dsent.finalize()
+
+    network_links = [ link.network_link for link in network.int_links ]
+    for link in network.ext_links:
+        network_links.extend(link.network_links)
+
+    dsent.initialize(options.dsent_link_config)
+    energy = dict(dsent.computeLinkPower(frequency))
+    for link in network_links:
+        link.default_p_state = "ON"
+        link.power_model = PowerModel(pm = [ GarnetLinkPowerModel(
+            traversal_energy = energy["Traversal energy: "],
+            static_power = energy["Static power: "]) ] + off_states())
+    dsent.finalize()
+
+def partition_quantum(options):
+    """The simulation quantum for a partitioned garnet network, in ticks:
+    the latency of a link, which is the earliest a flit sent by one
+    partition can be seen by another."""
+
+    m5.ticks.fixGlobalFrequency()
+    return m5.ticks.fromSeconds(options.link_latency /
+        m5.util.convert.anyToFrequency(options.ruby_clock))
@@ -66,6 +66,16 @@ def define_options(parser):
     parser.add_option("--access-backing-store", action="store_true", default=False,
                       help="Should ruby maintain a second copy of memory")
 
+    parser.add_option("--ruby-atomic-warmup", action="store_true",
+                      default=False,
+                      help="let atomic CPUs warm up the ruby caches when \
+                            fast forwarding (implies --access-backing-store)")
+
+    parser.add_option("--ruby-transition-counts", action="store",
+                      type="string", default="",
+                      help="dump the protocol transition counts in binary \
+                            form to this file at every stats dump")
+
     # Options related to cache structure
     parser.add_option("--ports", action="store", type="int", default=4,
                       help="used of transitions per cycle which is a proxy \
@@ -159,6 +169,12 @@ def create_system(options, full_system, system, piobus = None, dma_ports = [],
 
     system.ruby = RubySystem()
     ruby = system.ruby
+    ruby.transition_counts_file = options.ruby_transition_counts
+
+    # Atomic warm-up leaves the data to the backing store
+    if options.ruby_atomic_warmup:
+        options.access_backing_store = True
+        ruby.atomic_warmup = True
 
     # Generate pseudo filesystem
     FileSystemConfig.config_filesystem(system, options)
@@ -42,18 +42,22 @@ StaticInstPtr
 BasicDecodeCache::decode(TheISA::Decoder *decoder,
         TheISA::ExtMachInst mach_inst, Addr addr)
 {
-    StaticInstPtr &si = decodePages.lookup(addr);
-    if (si && (si->machInst == mach_inst))
-        return si;
+    StaticInstPtr *recent = recentInsts.lookup(addr);
+    if (recent && (*recent)->machInst == mach_inst)
+        return *recent;
 
-    auto iter = instMap.find(mach_inst);
-    if (iter != instMap.end()) {
-        si = iter->second;
-        return si;
+    StaticInstPtr &si = decodePages.lookup(addr);
+    if (!si || si->machInst != mach_inst) {
+        auto iter = instMap.find(mach_inst);
+        if (iter != instMap.end()) {
+            si = iter->second;
+        } else {
+            si = decoder->decodeInst(mach_inst);
+            instMap[mach_inst] = si;
+        }
     }
 
-    si = decoder->decodeInst(mach_inst);
-    instMap[mach_inst] = si;
+    recentInsts.insert(addr, 0, si);
     return si;
 }
 
@@ -49,6 +49,9 @@ class BasicDecodeCache
   private:
     DecodeCache::InstMap<TheISA::ExtMachInst> instMap;
     DecodeCache::AddrMap<StaticInstPtr> decodePages;
+    /// Recently decoded instructions, indexed by PC. Instructions are
+    /// at least halfword aligned on every ISA using this cache.
+    DecodeCache::DirectMap<StaticInstPtr, 12, 1> recentInsts;
 
   public:
     /// Decode a machine instruction.
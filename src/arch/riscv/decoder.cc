@@ -83,13 +83,21 @@ Decoder::decode(ExtMachInst mach_inst, Addr addr)
 {
     DPRINTF(Decode, "Decoding instruction 0x%08x at address %#x\n",
             mach_inst, addr);
-    if (instMap.find(mach_inst) != instMap.end())
-        return instMap[mach_inst];
-    else {
-        StaticInstPtr si = decodeInst(mach_inst);
+    StaticInstPtr *recent = recentInsts.lookup(addr);
+    if (recent && (*recent)->machInst == mach_inst)
+        return *recent;
+
+    StaticInstPtr si;
+    auto iter = instMap.find(mach_inst);
+    if (iter != instMap.end()) {
+        si = iter->second;
+    } else {
+        si = decodeInst(mach_inst);
         instMap[mach_inst] = si;
-        return si;
     }
+
+    recentInsts.insert(addr, 0, si);
+    return si;
 }
 
 StaticInstPtr
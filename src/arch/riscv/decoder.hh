@@ -49,6 +49,7 @@ class Decoder
 {
   private:
     DecodeCache::InstMap<ExtMachInst> instMap;
+    DecodeCache::DirectMap<StaticInstPtr, 12, 1> recentInsts;
     bool aligned;
     bool mid;
     bool more;
@@ -44,7 +44,13 @@ Decoder::doResetState()
 {
     origPC = basePC + offset;
     DPRINTF(Decoder, "Setting origPC to %#x\n", origPC);
-    instBytes = &decodePages->lookup(origPC);
+    InstBytes **recent = recentBytes.lookup(origPC, decodeMode);
+    if (recent) {
+        instBytes = *recent;
+    } else {
+        instBytes = &decodePages->lookup(origPC);
+        recentBytes.insert(origPC, decodeMode, instBytes);
+    }
     chunkIdx = 0;
 
     emi.rex = 0;
@@ -229,6 +229,11 @@ class Decoder
     typedef std::unordered_map<CacheKey, DecodePages *> AddrCacheMap;
     AddrCacheMap addrCacheMap;
 
+    /// The m5Reg decodePages and instMap were selected with.
+    CacheKey decodeMode;
+    /// Recently used entries of decodePages, indexed by PC and mode.
+    DecodeCache::DirectMap<InstBytes *> recentBytes;
+
     DecodeCache::InstMap<ExtMachInst> *instMap;
     typedef std::unordered_map<
             CacheKey, DecodeCache::InstMap<ExtMachInst> *> InstCacheMap;
@@ -251,6 +256,7 @@ class Decoder
         stack = 0;
         instBytes = &dummy;
         decodePages = NULL;
+        decodeMode = 0;
         instMap = NULL;
     }
 
@@ -265,6 +271,7 @@ class Decoder
         altAddr = m5Reg.altAddr;
         defAddr = m5Reg.defAddr;
         stack = m5Reg.stack;
+        decodeMode = m5Reg;
 
         AddrCacheMap::iterator amIter = addrCacheMap.find(m5Reg);
         if (amIter != addrCacheMap.end()) {
@@ -204,6 +204,14 @@ class RefCountingPtr
     template <bool B = TisConst>
     RefCountingPtr(const NonConstT &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer to the base class of
+    /// the object another one points to. Adds a reference.
+    template <class U, class = typename std::enable_if<
+        std::is_convertible<U *, T *>::value &&
+        !std::is_same<typename std::remove_cv<U>::type,
+                      typename std::remove_cv<T>::type>::value>::type>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
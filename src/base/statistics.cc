@@ -34,7 +34,9 @@
 #include <iomanip>
 #include <list>
 #include <map>
+#include <regex>
 #include <string>
+#include <unordered_map>
 
 #include "base/callback.hh"
 #include "base/cprintf.hh"
@@ -66,6 +68,148 @@ statsMap()
     return the_map;
 }
 
+uint64_t resetGeneration = 0;
+Tick resetTick = 0;
+
+__thread unsigned threadShard = 0;
+
+namespace {
+
+// The sharded storages, for initShards(). Never freed, as stats may
+// outlive static objects.
+list<ShardedStorBase *> &
+shardedList()
+{
+    static list<ShardedStorBase *> *the_list =
+        new list<ShardedStorBase *>;
+    return *the_list;
+}
+
+unsigned numShards = 1;
+
+/** The patterns of setFilter(), empty if all stats are selected. */
+vector<regex> &
+filterPatterns()
+{
+    static vector<regex> the_patterns;
+    return the_patterns;
+}
+
+/**
+ * Whether each group seen so far is selected. There are far fewer
+ * groups than stats, so this saves matching the patterns for the
+ * groups of every stat.
+ */
+unordered_map<string, bool> &
+filterGroups()
+{
+    static unordered_map<string, bool> the_groups;
+    return the_groups;
+}
+
+bool
+filterMatch(const string &name)
+{
+    for (const auto &pattern : filterPatterns()) {
+        if (regex_match(name, pattern))
+            return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+void
+setFilter(const vector<string> &patterns)
+{
+    fatal_if(enabled(), "Stats can't be filtered once they are enabled.\n");
+
+    vector<regex> &filter = filterPatterns();
+    filter.clear();
+    filterGroups().clear();
+    for (const auto &pattern : patterns) {
+        try {
+            filter.emplace_back(pattern, regex::nosubs | regex::optimize);
+        } catch (const regex_error &e) {
+            fatal("Bad stat filter '%s': %s\n", pattern, e.what());
+        }
+    }
+}
+
+bool
+selected(const string &name)
+{
+    if (filterPatterns().empty())
+        return true;
+
+    // A stat is in the groups named by each prefix of its name that
+    // ends before a '.'.
+    unordered_map<string, bool> &groups = filterGroups();
+    for (auto dot = name.find('.'); dot != string::npos;
+         dot = name.find('.', dot + 1)) {
+        auto group = groups.emplace(name.substr(0, dot), false);
+        if (group.second)
+            group.first->second = filterMatch(group.first->first);
+        if (group.first->second)
+            return true;
+    }
+
+    return filterMatch(name);
+}
+
+void
+removeFiltered()
+{
+    for (auto *info : statsList()) {
+        auto *formula = dynamic_cast<FormulaInfo *>(info);
+        if (formula && !formula->flags.isSet(filtered) &&
+                formula->readsFiltered()) {
+            warn("Filtering out %s, which reads stats that were filtered "
+                 "out.\n", formula->name);
+            formula->flags.clear(display);
+            formula->flags.set(filtered);
+        }
+    }
+
+    statsList().remove_if([](const Info *info) {
+        return info->flags.isSet(filtered);
+    });
+}
+
+ShardedStorBase::ShardedStorBase()
+{
+    fatal_if(numShards > 1, "Sharded stats must be created before the "
+             "simulation threads start.\n");
+    list<ShardedStorBase *> &sharded = shardedList();
+    listPos = sharded.insert(sharded.end(), this);
+}
+
+ShardedStorBase::~ShardedStorBase()
+{
+    shardedList().erase(listPos);
+}
+
+void
+setThreadShard(unsigned shard)
+{
+    assert(shard < numShards);
+    threadShard = shard;
+}
+
+void
+initShards(unsigned num_shards)
+{
+    assert(numShards == 1 && num_shards >= 1);
+    numShards = num_shards;
+
+    // Allocate a whole thread's worth of shards at a time, so that
+    // shards used by different threads don't share cache lines.
+    for (unsigned shard = 1; shard < num_shards; ++shard) {
+        for (auto s : shardedList())
+            s->addShard();
+    }
+}
+
 void
 InfoAccess::setInfo(Info *info)
 {
@@ -126,7 +270,8 @@ int Info::id_count = 0;
 int debug_break_id = -1;
 
 Info::Info()
-    : flags(none), precision(-1), prereq(0), storageParams(NULL)
+    : flags(none), precision(-1), prereq(0), counter(false),
+      storageParams(NULL)
 {
     id = id_count++;
     if (debug_break_id >= 0 and debug_break_id == id)
@@ -376,11 +521,254 @@ HistStor::add(HistStor *hs)
         cvec[i] += hs->cvec[i];
 }
 
+void
+LogHistStor::prepare(Info *info, DistData &data)
+{
+    const Params *params = safe_cast<const Params *>(info->storageParams);
+
+    assert(params->type == LogHist);
+    data.type = params->type;
+    data.min = 0;
+    data.max = max_track;
+    data.bucket_size = 0;
+
+    data.min_val = (min_val == CounterLimits::max()) ? 0 : min_val;
+    data.max_val = (max_val == CounterLimits::min()) ? 0 : max_val;
+    data.underflow = underflow;
+    data.overflow = overflow;
+
+    data.cvec.clear();
+    data.bucket_low.clear();
+    data.bucket_high.clear();
+    for (off_type i = 0; i < cvec.size(); ++i) {
+        if (cvec[i] == Counter())
+            continue;
+        data.cvec.push_back(cvec[i]);
+        data.bucket_low.push_back(bucketLow(i, sub_bucket_bits));
+        data.bucket_high.push_back(bucketHigh(i, sub_bucket_bits));
+    }
+
+    data.sum = sum;
+    data.squares = squares;
+    data.logs = 0.0;
+    data.samples = samples;
+
+    // Like HdrHistogram, report the highest value that is equivalent to
+    // the one at each percentile, but no more than the largest sample.
+    static const Result ranks[] = { 50, 90, 99, 99.9, 99.99 };
+    const size_type buckets = data.cvec.size();
+    Counter seen = underflow;
+    off_type bucket = 0;
+
+    data.percentiles.clear();
+    for (Result rank : ranks) {
+        Counter target = std::max(std::ceil(rank / 100 * samples), 1.0);
+        while (bucket < buckets && seen + data.cvec[bucket] < target)
+            seen += data.cvec[bucket++];
+
+        Counter value;
+        if (!samples)
+            value = NAN;
+        else if (target <= underflow)
+            value = data.min_val;
+        else if (bucket < buckets)
+            value = std::min(data.bucket_high[bucket], data.max_val);
+        else
+            value = data.max_val;
+        data.percentiles.emplace_back(rank, value);
+    }
+}
+
+off_type
+Node::compile(FormulaProgram &prog) const
+{
+    return prog.call(this);
+}
+
+off_type
+ScalarStatNode::compile(FormulaProgram &prog) const
+{
+    if (!scalar)
+        return Node::compile(prog);
+    const Scalar *s = scalar;
+    return prog.operand(s->valuePtr(), 1, [s]() { s->refresh(); });
+}
+
+off_type
+VectorStatNode::compile(FormulaProgram &prog) const
+{
+    if (!vector || !vector->valuePtr())
+        return Node::compile(prog);
+    const Vector *v = vector;
+    return prog.operand(v->valuePtr(), v->size(), [v]() { v->refresh(); });
+}
+
+off_type
+FormulaProgram::emit(OpCode op, size_type size, off_type a, off_type b,
+                     const Node *node)
+{
+    Result *out = nullptr;
+    if (op != Call) {
+        buffers.emplace_back(new Result[size]());
+        out = buffers.back().get();
+    }
+    off_type dst = operand(out, size);
+    code.push_back(Instr{op, dst, a, b, out, node});
+    return dst;
+}
+
+off_type
+FormulaProgram::call(const Node *node)
+{
+    return emit(Call, node->size(), 0, 0, node);
+}
+
+off_type
+FormulaProgram::unary(OpCode op, off_type a)
+{
+    assert(op == Negate || op == Sum);
+    return emit(op, op == Sum ? 1 : operands[a].size, a, 0, nullptr);
+}
+
+off_type
+FormulaProgram::binary(OpCode op, off_type a, off_type b)
+{
+    size_type as = operands[a].size;
+    size_type bs = operands[b].size;
+    assert(as > 0 && bs > 0);
+    assert((as == bs || as == 1 || bs == 1) &&
+           "Node vector sizes are not equal");
+    return emit(op, as == 1 ? bs : as, a, b, nullptr);
+}
+
+namespace {
+
+template <class Op>
+void
+binaryLoop(Result *out, size_type size, const FormulaProgram::Operand &a,
+           const FormulaProgram::Operand &b)
+{
+    Op op;
+    const Result *ad = a.data;
+    const Result *bd = b.data;
+    if (a.size == 1) {
+        Result av = ad[0];
+        for (off_type i = 0; i < size; ++i)
+            out[i] = op(av, bd[i]);
+    } else if (b.size == 1) {
+        Result bv = bd[0];
+        for (off_type i = 0; i < size; ++i)
+            out[i] = op(ad[i], bv);
+    } else {
+        for (off_type i = 0; i < size; ++i)
+            out[i] = op(ad[i], bd[i]);
+    }
+}
+
+Result
+sumOf(const FormulaProgram::Operand &opd)
+{
+    Result sum = 0.0;
+    for (off_type i = 0; i < opd.size; ++i)
+        sum += opd.data[i];
+    return sum;
+}
+
+} // anonymous namespace
+
+void
+FormulaProgram::run()
+{
+    if (generation != resetGeneration) {
+        for (auto &refresh : sources)
+            refresh();
+        generation = resetGeneration;
+    }
+
+    for (const Instr &instr : code) {
+        Operand &dst = operands[instr.dst];
+        switch (instr.op) {
+          case Call:
+            {
+                const VResult &vec = instr.node->result();
+                assert(vec.size() == dst.size);
+                dst.data = vec.data();
+            }
+            break;
+          case Negate:
+            {
+                const Result *a = operands[instr.a].data;
+                for (off_type i = 0; i < dst.size; ++i)
+                    instr.out[i] = -a[i];
+            }
+            break;
+          case Sum:
+            instr.out[0] = sumOf(operands[instr.a]);
+            break;
+          case Add:
+            binaryLoop<std::plus<Result> >(instr.out, dst.size,
+                operands[instr.a], operands[instr.b]);
+            break;
+          case Subtract:
+            binaryLoop<std::minus<Result> >(instr.out, dst.size,
+                operands[instr.a], operands[instr.b]);
+            break;
+          case Multiply:
+            binaryLoop<std::multiplies<Result> >(instr.out, dst.size,
+                operands[instr.a], operands[instr.b]);
+            break;
+          case Divide:
+            binaryLoop<std::divides<Result> >(instr.out, dst.size,
+                operands[instr.a], operands[instr.b]);
+            break;
+        }
+    }
+}
+
+Result
+FormulaProgram::total(off_type idx) const
+{
+    // Only the instruction that produced the operand knows whether its
+    // total is more than the sum of its results.
+    if (!code.empty() && code.back().dst == idx) {
+        const Instr &instr = code.back();
+        const Operand &a = operands[instr.a];
+        const Operand &b = operands[instr.b];
+        switch (instr.op) {
+          case Call:
+            return instr.node->total();
+          case Add:
+          case Subtract:
+          case Multiply:
+          case Divide:
+            // Vectors of the same size are combined after summing them,
+            // as in BinaryNode::total()
+            if (a.size == b.size && a.size > 1) {
+                Result as = sumOf(a);
+                Result bs = sumOf(b);
+                switch (instr.op) {
+                  case Add: return as + bs;
+                  case Subtract: return as - bs;
+                  case Multiply: return as * bs;
+                  default: return as / bs;
+                }
+            }
+            break;
+          default:
+            break;
+        }
+    }
+
+    return sumOf(operands[idx]);
+}
+
 Formula::Formula()
+    : programResult(0)
 {
 }
 
 Formula::Formula(Temp r)
+    : programResult(0)
 {
     root = r.getNodePtr();
     setInit();
@@ -407,6 +795,7 @@ Formula::operator+=(Temp r)
         setInit();
     }
 
+    program.reset();
     assert(size());
     return *this;
 }
@@ -417,20 +806,41 @@ Formula::operator/=(Temp r)
     assert (root);
     root = NodePtr(new BinaryNode<std::divides<Result> >(root, r));
 
+    program.reset();
     assert(size());
     return *this;
 }
 
+void
+Formula::compile()
+{
+    program.reset();
+    if (!root)
+        return;
+
+    program.reset(new FormulaProgram);
+    programResult = root->compile(*program);
+}
+
 void
 Formula::result(VResult &vec) const
 {
-    if (root)
+    if (program) {
+        program->run();
+        const FormulaProgram::Operand &res = program->get(programResult);
+        vec.assign(res.data, res.data + res.size);
+    } else if (root) {
         vec = root->result();
+    }
 }
 
 Result
 Formula::total() const
 {
+    if (program) {
+        program->run();
+        return program->total(programResult);
+    }
     return root ? root->total() : 0.0;
 }
 
@@ -451,6 +861,15 @@ Formula::reset()
 bool
 Formula::zero() const
 {
+    if (program) {
+        program->run();
+        const FormulaProgram::Operand &res = program->get(programResult);
+        for (off_type i = 0; i < res.size; ++i)
+            if (res.data[i] != 0.0)
+                return false;
+        return true;
+    }
+
     VResult vec;
     result(vec);
     for (VResult::size_type i = 0; i < vec.size(); ++i)
@@ -531,6 +950,16 @@ reset()
         fatal("No registered Stats::reset handler");
 }
 
+void
+resetAll()
+{
+    ++resetGeneration;
+    resetTick = curTick();
+
+    for (auto s : shardedList())
+        s->reset();
+}
+
 void
 registerDumpCallback(Callback *cb)
 {
@@ -66,6 +66,7 @@
 #include "base/stats/info.hh"
 #include "base/stats/output.hh"
 #include "base/stats/types.hh"
+#include "base/bitfield.hh"
 #include "base/cast.hh"
 #include "base/cprintf.hh"
 #include "base/intmath.hh"
@@ -170,9 +171,66 @@ struct StorageParams
     virtual ~StorageParams();
 };
 
+/**
+ * The number of times resetAll() has been called. Stats remember the
+ * generation they were last reset in, and reset themselves when they
+ * are next accessed if it has moved on since. @sa DataWrap::refresh()
+ */
+extern uint64_t resetGeneration;
+
+/** The tick of the last resetAll(). */
+extern Tick resetTick;
+
+/**
+ * Only register the stats selected by the given patterns. A stat is
+ * selected if a pattern, a regular expression, matches its name or
+ * the name of a group it is in: the SimObject it belongs to or one of
+ * that object's parents. Stats that aren't selected are never given
+ * storage, updating them does nothing and they are never dumped.
+ * This has to be called before the stats are registered.
+ * @param patterns The patterns, an empty list selects all stats.
+ */
+void setFilter(const std::vector<std::string> &patterns);
+
+/**
+ * Is the stat with the given name selected by the filter?
+ * @sa setFilter
+ */
+bool selected(const std::string &name);
+
+/**
+ * Remove the stats that were filtered out from statsList(), once all
+ * of the stats have been registered. Formulas that read a stat that
+ * was filtered out would print zeros for it, so they are filtered out
+ * too.
+ */
+void removeFiltered();
+
+/**
+ * Whether stats with the given storage are reset lazily. Storages that
+ * can't be, for example because they are updated from several threads,
+ * are reset by resetAll() itself.
+ */
+template <class Stor>
+struct LazyReset
+{
+    static const bool value = true;
+};
+
 class InfoAccess
 {
+  private:
+    /** The reset generation this stat was last reset in. */
+    mutable uint64_t generation;
+
   protected:
+    InfoAccess() : generation(resetGeneration) { }
+
+    /** Has there been a resetAll() since this stat was last reset? */
+    bool stale() const { return generation != resetGeneration; }
+    /** Mark the stat as reset in the current generation. */
+    void setFresh() const { generation = resetGeneration; }
+
     /** Set up an info class for this statistic */
     void setInfo(Info *info);
     /** Save Storage class parameters if any */
@@ -191,6 +249,12 @@ class InfoAccess
      */
     void reset() { }
 
+    /**
+     * Free the storage of a stat that has been filtered out. Stats
+     * that keep their storage inline have nothing to free.
+     */
+    void discard() { }
+
     /**
      * @return true if this stat has a value and satisfies its
      * requirement as a prereq
@@ -245,6 +309,35 @@ class DataWrap : public InfoAccess
         this->setInfo(new Info(self()));
     }
 
+    /**
+     * Reset the stat if there has been a resetAll() since it was last
+     * reset. Everything that reads or updates the storage of a stat
+     * goes through here first.
+     */
+    void
+    refresh() const
+    {
+        typedef typename Derived::Storage Storage;
+        if (LazyReset<Storage>::value && this->stale()) {
+            this->setFresh();
+            const_cast<DataWrap *>(this)->self().reset();
+        }
+    }
+
+  protected:
+    /**
+     * Start a reset of the storage. Any lazy reset that is still
+     * pending is done first, so that storages that keep the tick they
+     * were reset at (AvgStor) see the reset of resetAll() as well.
+     */
+    void
+    startReset()
+    {
+        refresh();
+        this->setFresh();
+    }
+
+  public:
     /**
      * Set the name and marks this stat to print at the end of simulation.
      * @param name The new name.
@@ -255,7 +348,12 @@ class DataWrap : public InfoAccess
     {
         Info *info = this->info();
         info->setName(name);
-        info->flags.set(display);
+        if (selected(name)) {
+            info->flags.set(display);
+        } else {
+            info->flags.set(filtered);
+            this->self().discard();
+        }
         return this->self();
     }
     const std::string &name() const { return this->info()->name; }
@@ -286,7 +384,9 @@ class DataWrap : public InfoAccess
     Derived &
     desc(const std::string &_desc)
     {
-        this->info()->desc = _desc;
+        Info *info = this->info();
+        if (!info->flags.isSet(filtered))
+            info->desc = _desc;
         return this->self();
     }
 
@@ -324,7 +424,10 @@ class DataWrap : public InfoAccess
     Derived &
     prereq(const Stat &prereq)
     {
-        this->info()->prereq = prereq.info();
+        // A stat that was filtered out always reads as zero, so it
+        // can't be a prerequisite.
+        if (!prereq.info()->flags.isSet(filtered))
+            this->info()->prereq = prereq.info();
         return this->self();
     }
 };
@@ -359,6 +462,8 @@ class DataWrapVec : public DataWrap<Derived, InfoProxyType>
     {
         Derived &self = this->self();
         Info *info = self.info();
+        if (info->flags.isSet(filtered))
+            return self;
 
         std::vector<std::string> &subn = info->subnames;
         if (subn.size() <= index)
@@ -382,6 +487,8 @@ class DataWrapVec : public DataWrap<Derived, InfoProxyType>
     subdesc(off_type index, const std::string &desc)
     {
         Info *info = this->info();
+        if (info->flags.isSet(filtered))
+            return this->self();
 
         std::vector<std::string> &subd = info->subdescs;
         if (subd.size() <= index)
@@ -397,7 +504,7 @@ class DataWrapVec : public DataWrap<Derived, InfoProxyType>
         Derived &self = this->self();
         Info *info = this->info();
 
-        size_t size = self.size();
+        size_t size = self.storage ? self.size() : 0;
         for (off_type i = 0; i < size; ++i)
             self.data(i)->prepare(info);
     }
@@ -408,7 +515,8 @@ class DataWrapVec : public DataWrap<Derived, InfoProxyType>
         Derived &self = this->self();
         Info *info = this->info();
 
-        size_t size = self.size();
+        this->startReset();
+        size_t size = self.storage ? self.size() : 0;
         for (off_type i = 0; i < size; ++i)
             self.data(i)->reset(info);
     }
@@ -429,6 +537,8 @@ class DataWrapVec2d : public DataWrapVec<Derived, InfoProxyType>
     {
         Derived &self = this->self();
         Info *info = this->info();
+        if (info->flags.isSet(filtered))
+            return self;
 
         info->y_subnames.resize(self.y);
         for (off_type i = 0; i < self.y; ++i)
@@ -441,6 +551,8 @@ class DataWrapVec2d : public DataWrapVec<Derived, InfoProxyType>
     {
         Derived &self = this->self();
         Info *info = this->info();
+        if (info->flags.isSet(filtered))
+            return self;
 
         assert(index < self.y);
         info->y_subnames.resize(self.y);
@@ -474,6 +586,9 @@ class StatStor
   public:
     struct Params : public StorageParams {};
 
+    /** The value only counts up between resets */
+    static const bool counter = true;
+
   public:
     /**
      * Builds this storage element and calls the base constructor of the
@@ -517,6 +632,16 @@ class StatStor
      */
     void reset(Info *info) { data = Counter(); }
 
+    /**
+     * Add the value of another storage to this one.
+     */
+    void add(const StatStor *other) { data += other->data; }
+
+    /**
+     * Where the value lives, for formulas that read it directly.
+     */
+    const Counter *valuePtr() const { return &data; }
+
     /**
      * @return true if zero value
      */
@@ -537,6 +662,8 @@ class AvgStor
     Counter current;
     /** The tick of the last reset */
     Tick lastReset;
+    /** The reset generation of the last reset */
+    uint64_t generation;
     /** The total count for all tick. */
     mutable Result total;
     /** The tick that current last changed. */
@@ -545,12 +672,16 @@ class AvgStor
   public:
     struct Params : public StorageParams {};
 
+    /** The value is a mean over time, not a count */
+    static const bool counter = false;
+
   public:
     /**
      * Build and initializes this stat storage.
      */
     AvgStor(Info *info)
-        : current(0), lastReset(0), total(0), last(0)
+        : current(0), lastReset(0), generation(resetGeneration), total(0),
+          last(0)
     { }
 
     /**
@@ -616,9 +747,17 @@ class AvgStor
     void
     reset(Info *info)
     {
-        total = 0.0;
+        if (generation != resetGeneration) {
+            // The first reset after a resetAll(), which may only be
+            // happening now that the stat is touched again. The count
+            // hasn't changed since, so account for it from then on.
+            generation = resetGeneration;
+            lastReset = resetTick;
+        } else {
+            lastReset = curTick();
+        }
+        total = current * (curTick() - lastReset);
         last = curTick();
-        lastReset = curTick();
     }
 
 };
@@ -647,6 +786,7 @@ class ScalarBase : public DataWrap<Derived, ScalarInfoProxy>
     Storage *
     data()
     {
+        this->refresh();
         return reinterpret_cast<Storage *>(storage);
     }
 
@@ -659,6 +799,7 @@ class ScalarBase : public DataWrap<Derived, ScalarInfoProxy>
     const Storage *
     data() const
     {
+        this->refresh();
         return reinterpret_cast<const Storage *>(storage);
     }
 
@@ -679,9 +820,15 @@ class ScalarBase : public DataWrap<Derived, ScalarInfoProxy>
   public:
     ScalarBase()
     {
+        this->info()->counter = Storage::counter;
         this->doInit();
     }
 
+    ~ScalarBase()
+    {
+        reinterpret_cast<Storage *>(storage)->~Storage();
+    }
+
   public:
     // Common operators for stats
     /**
@@ -738,7 +885,13 @@ class ScalarBase : public DataWrap<Derived, ScalarInfoProxy>
 
     bool zero() { return result() == 0.0; }
 
-    void reset() { data()->reset(this->info()); }
+    void
+    reset()
+    {
+        this->startReset();
+        data()->reset(this->info());
+    }
+
     void prepare() { data()->prepare(this->info()); }
 };
 
@@ -881,13 +1034,21 @@ class ScalarProxy
      * Return the current value of this stat as its base type.
      * @return The current value.
      */
-    Counter value() const { return stat.data(index)->value(); }
+    Counter
+    value() const
+    {
+        return stat.storage ? stat.data(index)->value() : Counter();
+    }
 
     /**
      * Return the current value of this statas a result type.
      * @return The current value.
      */
-    Result result() const { return stat.data(index)->result(); }
+    Result
+    result() const
+    {
+        return stat.storage ? stat.data(index)->result() : Result();
+    }
 
   public:
     /**
@@ -921,17 +1082,18 @@ class ScalarProxy
     }
 
   public:
-    // Common operators for stats
+    // Common operators for stats. They do nothing if the stat has been
+    // filtered out and has no storage.
     /**
      * Increment the stat by 1. This calls the associated storage object inc
      * function.
      */
-    void operator++() { stat.data(index)->inc(1); }
+    void operator++() { if (stat.storage) stat.data(index)->inc(1); }
     /**
      * Decrement the stat by 1. This calls the associated storage object dec
      * function.
      */
-    void operator--() { stat.data(index)->dec(1); }
+    void operator--() { if (stat.storage) stat.data(index)->dec(1); }
 
     /** Increment the stat by 1. */
     void operator++(int) { ++*this; }
@@ -947,7 +1109,8 @@ class ScalarProxy
     void
     operator=(const U &v)
     {
-        stat.data(index)->set(v);
+        if (stat.storage)
+            stat.data(index)->set(v);
     }
 
     /**
@@ -959,7 +1122,8 @@ class ScalarProxy
     void
     operator+=(const U &v)
     {
-        stat.data(index)->inc(v);
+        if (stat.storage)
+            stat.data(index)->inc(v);
     }
 
     /**
@@ -971,7 +1135,8 @@ class ScalarProxy
     void
     operator-=(const U &v)
     {
-        stat.data(index)->dec(v);
+        if (stat.storage)
+            stat.data(index)->dec(v);
     }
 
     /**
@@ -980,6 +1145,9 @@ class ScalarProxy
      */
     size_type size() const { return 1; }
 
+    /** Was the stat filtered out, so that it has no storage? */
+    bool isFiltered() const { return !stat.storage; }
+
   public:
     std::string
     str() const
@@ -1015,14 +1183,24 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
      * @param index The vector index to access.
      * @return The storage object at the given index.
      */
-    Storage *data(off_type index) { return &storage[index]; }
+    Storage *
+    data(off_type index)
+    {
+        this->refresh();
+        return &storage[index];
+    }
 
     /**
      * Retrieve a const pointer to the storage.
      * @param index The vector index to access.
      * @return A const pointer to the storage object at the given index.
      */
-    const Storage *data(off_type index) const { return &storage[index]; }
+    const Storage *
+    data(off_type index) const
+    {
+        this->refresh();
+        return &storage[index];
+    }
 
     void
     doInit(size_type s)
@@ -1031,11 +1209,14 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
         assert(!storage && "already initialized");
         _size = s;
 
-        char *ptr = new char[_size * sizeof(Storage)];
-        storage = reinterpret_cast<Storage *>(ptr);
+        Info *info = this->info();
+        if (!info->flags.isSet(filtered)) {
+            char *ptr = new char[_size * sizeof(Storage)];
+            storage = reinterpret_cast<Storage *>(ptr);
 
-        for (off_type i = 0; i < _size; ++i)
-            new (&storage[i]) Storage(this->info());
+            for (off_type i = 0; i < _size; ++i)
+                new (&storage[i]) Storage(info);
+        }
 
         this->setInit();
     }
@@ -1046,7 +1227,7 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
     {
         vec.resize(size());
         for (off_type i = 0; i < size(); ++i)
-            vec[i] = data(i)->value();
+            vec[i] = storage ? data(i)->value() : Counter();
     }
 
     /**
@@ -1058,7 +1239,7 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
     {
         vec.resize(size());
         for (off_type i = 0; i < size(); ++i)
-            vec[i] = data(i)->result();
+            vec[i] = storage ? data(i)->result() : Result();
     }
 
     /**
@@ -1069,7 +1250,7 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
     total() const
     {
         Result total = 0.0;
-        for (off_type i = 0; i < size(); ++i)
+        for (off_type i = 0; storage && i < size(); ++i)
             total += data(i)->result();
         return total;
     }
@@ -1082,7 +1263,7 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
     bool
     zero() const
     {
-        for (off_type i = 0; i < size(); ++i)
+        for (off_type i = 0; storage && i < size(); ++i)
             if (data(i)->zero())
                 return false;
         return true;
@@ -1094,19 +1275,32 @@ class VectorBase : public DataWrapVec<Derived, VectorInfoProxy>
         return storage != NULL;
     }
 
-  public:
-    VectorBase()
-        : storage(nullptr), _size(0)
-    {}
-
-    ~VectorBase()
+    /**
+     * Free the storage of this vector. It keeps its size, and reads as
+     * all zeros.
+     */
+    void
+    discard()
     {
         if (!storage)
             return;
 
         for (off_type i = 0; i < _size; ++i)
-            data(i)->~Storage();
+            storage[i].~Storage();
         delete [] reinterpret_cast<char *>(storage);
+        storage = nullptr;
+    }
+
+  public:
+    VectorBase()
+        : storage(nullptr), _size(0)
+    {
+        this->info()->counter = Storage::counter;
+    }
+
+    ~VectorBase()
+    {
+        discard();
     }
 
     /**
@@ -1167,7 +1361,7 @@ class VectorProxy
         vec.resize(size());
 
         for (off_type i = 0; i < size(); ++i)
-            vec[i] = data(i)->result();
+            vec[i] = stat.storage ? data(i)->result() : Result();
 
         return vec;
     }
@@ -1176,7 +1370,7 @@ class VectorProxy
     total() const
     {
         Result total = 0.0;
-        for (off_type i = 0; i < size(); ++i)
+        for (off_type i = 0; stat.storage && i < size(); ++i)
             total += data(i)->result();
         return total;
     }
@@ -1231,22 +1425,30 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     Storage *storage;
 
   protected:
-    Storage *data(off_type index) { return &storage[index]; }
-    const Storage *data(off_type index) const { return &storage[index]; }
+    Storage *
+    data(off_type index)
+    {
+        this->refresh();
+        return &storage[index];
+    }
+
+    const Storage *
+    data(off_type index) const
+    {
+        this->refresh();
+        return &storage[index];
+    }
 
   public:
     Vector2dBase()
         : x(0), y(0), _size(0), storage(nullptr)
-    {}
+    {
+        this->info()->counter = Storage::counter;
+    }
 
     ~Vector2dBase()
     {
-        if (!storage)
-            return;
-
-        for (off_type i = 0; i < _size; ++i)
-            data(i)->~Storage();
-        delete [] reinterpret_cast<char *>(storage);
+        discard();
     }
 
     Derived &
@@ -1264,11 +1466,13 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
         info->y = _y;
         _size = x * y;
 
-        char *ptr = new char[_size * sizeof(Storage)];
-        storage = reinterpret_cast<Storage *>(ptr);
+        if (!info->flags.isSet(filtered)) {
+            char *ptr = new char[_size * sizeof(Storage)];
+            storage = reinterpret_cast<Storage *>(ptr);
 
-        for (off_type i = 0; i < _size; ++i)
-            new (&storage[i]) Storage(info);
+            for (off_type i = 0; i < _size; ++i)
+                new (&storage[i]) Storage(info);
+        }
 
         this->setInit();
 
@@ -1293,7 +1497,7 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     bool
     zero() const
     {
-        return data(0)->zero();
+        return !storage || data(0)->zero();
     }
 
     /**
@@ -1304,7 +1508,7 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     total() const
     {
         Result total = 0.0;
-        for (off_type i = 0; i < size(); ++i)
+        for (off_type i = 0; storage && i < size(); ++i)
             total += data(i)->result();
         return total;
     }
@@ -1313,7 +1517,7 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     prepare()
     {
         Info *info = this->info();
-        size_type size = this->size();
+        size_type size = storage ? this->size() : 0;
 
         for (off_type i = 0; i < size; ++i)
             data(i)->prepare(info);
@@ -1330,7 +1534,8 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     reset()
     {
         Info *info = this->info();
-        size_type size = this->size();
+        size_type size = storage ? this->size() : 0;
+        this->startReset();
         for (off_type i = 0; i < size; ++i)
             data(i)->reset(info);
     }
@@ -1340,6 +1545,19 @@ class Vector2dBase : public DataWrapVec2d<Derived, Vector2dInfoProxy>
     {
         return storage != NULL;
     }
+
+    /** Free the storage of this vector, which then reads as zero. */
+    void
+    discard()
+    {
+        if (!storage)
+            return;
+
+        for (off_type i = 0; i < _size; ++i)
+            storage[i].~Storage();
+        delete [] reinterpret_cast<char *>(storage);
+        storage = nullptr;
+    }
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -1503,6 +1721,29 @@ class DistStor
         squares = Counter();
         samples = Counter();
     }
+
+    /**
+     * Add the samples of another distribution with the same
+     * parameters to this one.
+     */
+    void
+    add(const DistStor *ds)
+    {
+        assert(size() == ds->size());
+
+        min_val = std::min(min_val, ds->min_val);
+        max_val = std::max(max_val, ds->max_val);
+        underflow += ds->underflow;
+        overflow += ds->overflow;
+
+        size_type size = cvec.size();
+        for (off_type i = 0; i < size; ++i)
+            cvec[i] += ds->cvec[i];
+
+        sum += ds->sum;
+        squares += ds->squares;
+        samples += ds->samples;
+    }
 };
 
 /**
@@ -1652,90 +1893,284 @@ class HistStor
 };
 
 /**
- * Templatized storage and interface for a distribution that calculates mean
- * and variance.
+ * Templatized storage and interface for a log-linear histogram, in the
+ * style of HdrHistogram. Values are split into groups of 2^bits linear
+ * buckets, and each group covers twice the range of the one before it
+ * with buckets twice as wide. Values below 2^(bits + 1) have a bucket
+ * each, and larger ones are recorded with a relative error of at most
+ * 2^-bits. Unlike HistStor the buckets never change, so sampling takes
+ * constant time and histograms with the same parameters can be merged
+ * bucket by bucket.
  */
-class SampleStor
+class LogHistStor
 {
   public:
+    /** The parameters for a log-linear histogram stat. */
     struct Params : public DistParams
     {
-        Params() : DistParams(Deviation) {}
+        /** The log2 of the number of buckets in each group. */
+        unsigned sub_bucket_bits;
+        /** The maximum value to track. */
+        Counter max;
+        /** The number of buckets, up to the one that holds max. */
+        size_type buckets;
+
+        /**
+         * @param max The maximum value to track.
+         * @param bits The log2 of the number of buckets in each group.
+         */
+        Params(Counter max, unsigned bits)
+            : DistParams(LogHist), sub_bucket_bits(bits), max(max)
+        {
+            assert(max >= 0 && max < (Counter)(1ULL << 63));
+            assert(bits <= 16);
+            buckets = bucketIndex((uint64_t)max, bits) + 1;
+        }
     };
 
+    /**
+     * Return the bucket that holds a value.
+     * @param val The value, which is truncated to an integer.
+     * @param bits The log2 of the number of buckets in each group.
+     * @return The index of the bucket.
+     */
+    static size_type
+    bucketIndex(uint64_t val, unsigned bits)
+    {
+        int group = findMsbSet(val | mask(bits + 1)) - bits;
+        return (group << bits) + (val >> group);
+    }
+
+    /**
+     * Return the smallest value that goes to a bucket.
+     * @param index The index of the bucket.
+     * @param bits The log2 of the number of buckets in each group.
+     */
+    static Counter
+    bucketLow(size_type index, unsigned bits)
+    {
+        int group = std::max<int>((index >> bits) - 1, 0);
+        return (Counter)((uint64_t)(index - (group << bits)) << group);
+    }
+
+    /**
+     * Return the largest value that goes to a bucket.
+     * @param index The index of the bucket.
+     * @param bits The log2 of the number of buckets in each group.
+     */
+    static Counter
+    bucketHigh(size_type index, unsigned bits)
+    {
+        return bucketLow(index + 1, bits) - 1;
+    }
+
   private:
+    /** The log2 of the number of buckets in each group. */
+    unsigned sub_bucket_bits;
+    /** The maximum value to track. */
+    Counter max_track;
+
+    /** The smallest value sampled. */
+    Counter min_val;
+    /** The largest value sampled. */
+    Counter max_val;
+    /** The number of negative values sampled. */
+    Counter underflow;
+    /** The number of values sampled more than max. */
+    Counter overflow;
     /** The current sum. */
     Counter sum;
     /** The sum of squares. */
     Counter squares;
     /** The number of samples. */
     Counter samples;
+    /** Counter for each bucket. */
+    VCounter cvec;
 
   public:
-    /**
-     * Create and initialize this storage.
-     */
-    SampleStor(Info *info)
-        : sum(Counter()), squares(Counter()), samples(Counter())
-    { }
+    LogHistStor(Info *info)
+        : cvec(safe_cast<const Params *>(info->storageParams)->buckets)
+    {
+        reset(info);
+    }
 
     /**
-     * Add a value the given number of times to this running average.
-     * Update the running sum and sum of squares, increment the number of
-     * values seen by the given number.
+     * Add a value to the histogram for the given number of times.
      * @param val The value to add.
      * @param number The number of times to add the value.
      */
     void
     sample(Counter val, int number)
     {
-        Counter value = val * number;
-        sum += value;
-        squares += value * value;
+        if (val < 0)
+            underflow += number;
+        else if (val > max_track)
+            overflow += number;
+        else
+            cvec[bucketIndex((uint64_t)val, sub_bucket_bits)] += number;
+
+        if (val < min_val)
+            min_val = val;
+
+        if (val > max_val)
+            max_val = val;
+
+        sum += val * number;
+        squares += val * val * number;
         samples += number;
     }
 
     /**
-     * Return the number of entries in this stat, 1
-     * @return 1.
+     * Return the number of buckets in this histogram.
+     * @return the number of buckets.
      */
-    size_type size() const { return 1; }
+    size_type size() const { return cvec.size(); }
 
     /**
-     * Return true if no samples have been added.
-     * @return True if no samples have been added.
+     * Returns true if any calls to sample have been made.
+     * @return True if any values have been sampled.
      */
-    bool zero() const { return samples == Counter(); }
-
-    void
-    prepare(Info *info, DistData &data)
+    bool
+    zero() const
     {
-        const Params *params = safe_cast<const Params *>(info->storageParams);
-
-        assert(params->type == Deviation);
-        data.type = params->type;
-        data.sum = sum;
-        data.squares = squares;
-        data.samples = samples;
+        return samples == Counter();
     }
 
+    void prepare(Info *info, DistData &data);
+
     /**
      * Reset stat value to default
      */
     void
     reset(Info *info)
     {
+        const Params *params = safe_cast<const Params *>(info->storageParams);
+        sub_bucket_bits = params->sub_bucket_bits;
+        max_track = params->max;
+
+        min_val = CounterLimits::max();
+        max_val = CounterLimits::min();
+        underflow = Counter();
+        overflow = Counter();
+
+        size_type size = cvec.size();
+        for (off_type i = 0; i < size; ++i)
+            cvec[i] = Counter();
+
         sum = Counter();
         squares = Counter();
         samples = Counter();
     }
-};
 
-/**
- * Templatized storage for distribution that calculates per tick mean and
- * variance.
- */
-class AvgSampleStor
+    /**
+     * Add the samples of another histogram with the same parameters to
+     * this one.
+     */
+    void
+    add(const LogHistStor *hs)
+    {
+        assert(size() == hs->size());
+
+        min_val = std::min(min_val, hs->min_val);
+        max_val = std::max(max_val, hs->max_val);
+        underflow += hs->underflow;
+        overflow += hs->overflow;
+
+        size_type size = cvec.size();
+        for (off_type i = 0; i < size; ++i)
+            cvec[i] += hs->cvec[i];
+
+        sum += hs->sum;
+        squares += hs->squares;
+        samples += hs->samples;
+    }
+};
+
+/**
+ * Templatized storage and interface for a distribution that calculates mean
+ * and variance.
+ */
+class SampleStor
+{
+  public:
+    struct Params : public DistParams
+    {
+        Params() : DistParams(Deviation) {}
+    };
+
+  private:
+    /** The current sum. */
+    Counter sum;
+    /** The sum of squares. */
+    Counter squares;
+    /** The number of samples. */
+    Counter samples;
+
+  public:
+    /**
+     * Create and initialize this storage.
+     */
+    SampleStor(Info *info)
+        : sum(Counter()), squares(Counter()), samples(Counter())
+    { }
+
+    /**
+     * Add a value the given number of times to this running average.
+     * Update the running sum and sum of squares, increment the number of
+     * values seen by the given number.
+     * @param val The value to add.
+     * @param number The number of times to add the value.
+     */
+    void
+    sample(Counter val, int number)
+    {
+        Counter value = val * number;
+        sum += value;
+        squares += value * value;
+        samples += number;
+    }
+
+    /**
+     * Return the number of entries in this stat, 1
+     * @return 1.
+     */
+    size_type size() const { return 1; }
+
+    /**
+     * Return true if no samples have been added.
+     * @return True if no samples have been added.
+     */
+    bool zero() const { return samples == Counter(); }
+
+    void
+    prepare(Info *info, DistData &data)
+    {
+        const Params *params = safe_cast<const Params *>(info->storageParams);
+
+        assert(params->type == Deviation);
+        data.type = params->type;
+        data.sum = sum;
+        data.squares = squares;
+        data.samples = samples;
+    }
+
+    /**
+     * Reset stat value to default
+     */
+    void
+    reset(Info *info)
+    {
+        sum = Counter();
+        squares = Counter();
+        samples = Counter();
+    }
+};
+
+/**
+ * Templatized storage for distribution that calculates per tick mean and
+ * variance.
+ */
+class AvgSampleStor
 {
   public:
     struct Params : public DistParams
@@ -1806,6 +2241,185 @@ class AvgSampleStor
     }
 };
 
+//////////////////////////////////////////////////////////////////////
+//
+// Sharded Storage
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * The statistics shard of the calling thread. Zero on the main thread,
+ * and the event queue index on the threads of a parallel simulation.
+ * @sa ShardedStor
+ */
+extern __thread unsigned threadShard;
+
+/**
+ * Set the shard of the calling thread. Called by the simulation threads
+ * before they first run their event queue.
+ */
+void setThreadShard(unsigned shard);
+
+/**
+ * Give every sharded storage one shard for each of the num_shards - 1
+ * threads that run alongside the main thread. Called once, before the
+ * simulation threads start.
+ */
+void initShards(unsigned num_shards);
+
+/**
+ * The part of ShardedStor that doesn't depend on the storage type. All
+ * sharded storages are kept on a list so that initShards() can find
+ * them.
+ */
+class ShardedStorBase
+{
+  private:
+    std::list<ShardedStorBase *>::iterator listPos;
+
+  public:
+    ShardedStorBase();
+    virtual ~ShardedStorBase();
+
+    /** Append a shard for the next thread. */
+    virtual void addShard() = 0;
+    /** Reset all shards, for resetAll(). */
+    virtual void reset() = 0;
+};
+
+/**
+ * Storage that keeps one copy of the underlying storage per simulation
+ * thread, so that a stat can be updated from several event queues
+ * without locks or races. The main thread updates the base copy, which
+ * also holds the merged results. The other shards are folded into it,
+ * in shard order, whenever the stat is prepared for dumping, so the
+ * results don't depend on how the threads were scheduled. Reading a
+ * value while the simulation threads are running is not exact.
+ *
+ * The underlying storage has to provide add() to merge shards.
+ */
+template <class Stor>
+class ShardedStor : public ShardedStorBase
+{
+  public:
+    typedef typename Stor::Params Params;
+
+    static const bool counter = Stor::counter;
+
+  private:
+    Info *info;
+    /** The main thread's shard, and the merged results. */
+    Stor base;
+    /** The shards of the threads other than the main thread. */
+    std::vector<Stor *> shards;
+
+    Stor *
+    shard()
+    {
+        unsigned idx = threadShard;
+        return idx ? shards[idx - 1] : &base;
+    }
+
+    void
+    merge()
+    {
+        for (auto s : shards) {
+            base.add(s);
+            s->reset(info);
+        }
+    }
+
+  public:
+    ShardedStor(Info *info)
+        : info(info), base(info)
+    { }
+
+    ~ShardedStor()
+    {
+        for (auto s : shards)
+            delete s;
+    }
+
+    void addShard() override { shards.push_back(new Stor(info)); }
+
+    /**
+     * Set the total over all shards to the given value. This only
+     * writes the caller's shard, but reads the others.
+     */
+    void
+    set(Counter val)
+    {
+        Stor *mine = shard();
+        mine->set(val - (value() - mine->value()));
+    }
+    void inc(Counter val) { shard()->inc(val); }
+    void dec(Counter val) { shard()->dec(val); }
+
+    Counter
+    value() const
+    {
+        Counter total = base.value();
+        for (auto s : shards)
+            total += s->value();
+        return total;
+    }
+    Result result() const { return (Result)value(); }
+
+    void sample(Counter val, int number) { shard()->sample(val, number); }
+    size_type size() const { return base.size(); }
+
+    bool
+    zero() const
+    {
+        for (auto s : shards)
+            if (!s->zero())
+                return false;
+        return base.zero();
+    }
+
+    void
+    prepare(Info *info)
+    {
+        merge();
+        base.prepare(info);
+    }
+
+    void
+    prepare(Info *info, DistData &data)
+    {
+        merge();
+        base.prepare(info, data);
+    }
+
+    void
+    reset(Info *info)
+    {
+        base.reset(info);
+        for (auto s : shards)
+            s->reset(info);
+    }
+
+    void reset() override { reset(info); }
+
+    void
+    add(ShardedStor *other)
+    {
+        merge();
+        other->merge();
+        base.add(&other->base);
+    }
+};
+
+/**
+ * Sharded stats are reset by resetAll(), while the simulation threads
+ * are stopped, rather than by whichever thread touches them next.
+ */
+template <class Stor>
+struct LazyReset<ShardedStor<Stor> >
+{
+    static const bool value = false;
+};
+
 /**
  * Implementation of a distribution stat. The type of distribution is
  * determined by the Storage template. @sa ScalarBase
@@ -1821,6 +2435,8 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
   protected:
     /** The storage for this stat. */
     char storage[sizeof(Storage)] __attribute__ ((aligned (8)));
+    /** Set if the stat was filtered out, and storage isn't constructed. */
+    bool discarded;
 
   protected:
     /**
@@ -1830,6 +2446,7 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
     Storage *
     data()
     {
+        this->refresh();
         return reinterpret_cast<Storage *>(storage);
     }
 
@@ -1840,18 +2457,40 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
     const Storage *
     data() const
     {
+        this->refresh();
         return reinterpret_cast<const Storage *>(storage);
     }
 
     void
     doInit()
     {
-        new (storage) Storage(this->info());
+        Info *info = this->info();
+        discarded = info->flags.isSet(filtered);
+        if (!discarded)
+            new (storage) Storage(info);
         this->setInit();
     }
 
   public:
-    DistBase() { }
+    DistBase() : discarded(false) { }
+
+    ~DistBase()
+    {
+        if (this->info()->flags.isSet(init))
+            discard();
+    }
+
+    /**
+     * Destroy the storage of a distribution that has been filtered out,
+     * after which it reads as empty.
+     */
+    void
+    discard()
+    {
+        if (!discarded && this->info()->flags.isSet(init))
+            reinterpret_cast<Storage *>(storage)->~Storage();
+        discarded = true;
+    }
 
     /**
      * Add a value to the distribtion n times. Calls sample on the storage
@@ -1860,24 +2499,30 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
      * @param n The number of times to add it, defaults to 1.
      */
     template <typename U>
-    void sample(const U &v, int n = 1) { data()->sample(v, n); }
+    void
+    sample(const U &v, int n = 1)
+    {
+        if (!discarded)
+            data()->sample(v, n);
+    }
 
     /**
      * Return the number of entries in this stat.
      * @return The number of entries.
      */
-    size_type size() const { return data()->size(); }
+    size_type size() const { return discarded ? 0 : data()->size(); }
     /**
      * Return true if no samples have been added.
      * @return True if there haven't been any samples.
      */
-    bool zero() const { return data()->zero(); }
+    bool zero() const { return discarded || data()->zero(); }
 
     void
     prepare()
     {
         Info *info = this->info();
-        data()->prepare(info, info->data);
+        if (!discarded)
+            data()->prepare(info, info->data);
     }
 
     /**
@@ -1886,13 +2531,20 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
     void
     reset()
     {
-        data()->reset(this->info());
+        this->startReset();
+        if (!discarded)
+            data()->reset(this->info());
     }
 
     /**
      *  Add the argument distribution to the this distribution.
      */
-    void add(DistBase &d) { data()->add(d.data()); }
+    void
+    add(DistBase &d)
+    {
+        if (!discarded && !d.discarded)
+            data()->add(d.data());
+    }
 
 };
 
@@ -1918,12 +2570,14 @@ class VectorDistBase : public DataWrapVec<Derived, VectorDistInfoProxy>
     Storage *
     data(off_type index)
     {
+        this->refresh();
         return &storage[index];
     }
 
     const Storage *
     data(off_type index) const
     {
+        this->refresh();
         return &storage[index];
     }
 
@@ -1934,12 +2588,14 @@ class VectorDistBase : public DataWrapVec<Derived, VectorDistInfoProxy>
         assert(!storage && "already initialized");
         _size = s;
 
-        char *ptr = new char[_size * sizeof(Storage)];
-        storage = reinterpret_cast<Storage *>(ptr);
-
         Info *info = this->info();
-        for (off_type i = 0; i < _size; ++i)
-            new (&storage[i]) Storage(info);
+        if (!info->flags.isSet(filtered)) {
+            char *ptr = new char[_size * sizeof(Storage)];
+            storage = reinterpret_cast<Storage *>(ptr);
+
+            for (off_type i = 0; i < _size; ++i)
+                new (&storage[i]) Storage(info);
+        }
 
         this->setInit();
     }
@@ -1950,13 +2606,24 @@ class VectorDistBase : public DataWrapVec<Derived, VectorDistInfoProxy>
     {}
 
     ~VectorDistBase()
+    {
+        discard();
+    }
+
+    /**
+     * Free the storage of a vector of distributions that has been
+     * filtered out, after which they all read as empty.
+     */
+    void
+    discard()
     {
         if (!storage)
-            return ;
+            return;
 
         for (off_type i = 0; i < _size; ++i)
-            data(i)->~Storage();
+            storage[i].~Storage();
         delete [] reinterpret_cast<char *>(storage);
+        storage = NULL;
     }
 
     Proxy operator[](off_type index)
@@ -1974,7 +2641,7 @@ class VectorDistBase : public DataWrapVec<Derived, VectorDistInfoProxy>
     bool
     zero() const
     {
-        for (off_type i = 0; i < size(); ++i)
+        for (off_type i = 0; storage && i < size(); ++i)
             if (!data(i)->zero())
                 return false;
         return true;
@@ -1984,7 +2651,7 @@ class VectorDistBase : public DataWrapVec<Derived, VectorDistInfoProxy>
     prepare()
     {
         Info *info = this->info();
-        size_type size = this->size();
+        size_type size = storage ? this->size() : 0;
         info->data.resize(size);
         for (off_type i = 0; i < size; ++i)
             data(i)->prepare(info, info->data[i]);
@@ -2030,7 +2697,8 @@ class DistProxy
     void
     sample(const U &v, int n = 1)
     {
-        data()->sample(v, n);
+        if (stat.storage)
+            data()->sample(v, n);
     }
 
     size_type
@@ -2042,7 +2710,7 @@ class DistProxy
     bool
     zero() const
     {
-        return data()->zero();
+        return !stat.storage || data()->zero();
     }
 
     /**
@@ -2061,6 +2729,140 @@ class DistProxy
  * Base class for formula statistic node. These nodes are used to build a tree
  * that represents the formula.
  */
+class Node;
+class Scalar;
+class Vector;
+
+/**
+ * A Formula tree flattened into a linear program, so that evaluating it
+ * doesn't go through a virtual call and a temporary VResult per node.
+ * @sa Formula::compile
+ *
+ * Every value the program works on is an operand: a run of Results in
+ * the storage of a Scalar or Vector stat, in a constant node, or in a
+ * scratch buffer owned by the program. Each instruction writes one
+ * scratch operand. Nodes that can't be flattened are evaluated through
+ * Node::result() by a Call instruction, which just points its operand
+ * at the node's result.
+ */
+class FormulaProgram
+{
+  public:
+    enum OpCode { Call, Negate, Add, Subtract, Multiply, Divide, Sum };
+
+    struct Operand
+    {
+        const Result *data;
+        size_type size;
+    };
+
+  private:
+    struct Instr
+    {
+        OpCode op;
+        off_type dst;
+        off_type a;
+        off_type b;
+        /** The output buffer, null for Call */
+        Result *out;
+        /** The node to evaluate for Call */
+        const Node *node;
+    };
+
+    std::vector<Operand> operands;
+    std::vector<Instr> code;
+    std::vector<std::unique_ptr<Result[]> > buffers;
+    /** Refresh the stats whose storage is read directly */
+    std::vector<std::function<void()> > sources;
+    /** The reset generation the sources were last refreshed in */
+    uint64_t generation;
+
+    off_type emit(OpCode op, size_type size, off_type a, off_type b,
+                  const Node *node);
+
+  public:
+    FormulaProgram() : generation(resetGeneration) { }
+
+    /** Add an operand that reads existing storage. */
+    off_type
+    operand(const Result *data, size_type size)
+    {
+        operands.push_back(Operand{data, size});
+        return operands.size() - 1;
+    }
+
+    /**
+     * Add an operand that reads the storage of a stat, which has to be
+     * refreshed before it is read if there has been a resetAll().
+     */
+    off_type
+    operand(const Result *data, size_type size,
+            std::function<void()> refresh)
+    {
+        sources.push_back(refresh);
+        return operand(data, size);
+    }
+
+    /** Evaluate a node through Node::result(). */
+    off_type call(const Node *node);
+    /** Apply a unary operation (Negate or Sum) to an operand. */
+    off_type unary(OpCode op, off_type a);
+    /** Apply a binary operation, broadcasting operands of size 1. */
+    off_type binary(OpCode op, off_type a, off_type b);
+
+    /** Run the program. */
+    void run();
+
+    /** Access an operand, valid after run(). */
+    const Operand &get(off_type idx) const { return operands[idx]; }
+
+    /**
+     * The total of an operand, with the same semantics as Node::total()
+     * for the node that produced it. Valid after run().
+     */
+    Result total(off_type idx) const;
+};
+
+/**
+ * Map a node's operation to a FormulaProgram opcode. Operations that
+ * have no opcode map to Call.
+ */
+template <class Op>
+struct ProgramOp
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Call;
+};
+
+template<>
+struct ProgramOp<std::plus<Result> >
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Add;
+};
+
+template<>
+struct ProgramOp<std::minus<Result> >
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Subtract;
+};
+
+template<>
+struct ProgramOp<std::multiplies<Result> >
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Multiply;
+};
+
+template<>
+struct ProgramOp<std::divides<Result> >
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Divide;
+};
+
+template<>
+struct ProgramOp<std::negate<Result> >
+{
+    static const FormulaProgram::OpCode code = FormulaProgram::Negate;
+};
+
 class Node
 {
   public:
@@ -2085,6 +2887,19 @@ class Node
      */
     virtual std::string str() const = 0;
 
+    /**
+     * Append the instructions that evaluate this subtree to a program.
+     * By default the node is evaluated through result().
+     * @return The operand that holds the result of this subtree.
+     */
+    virtual off_type compile(FormulaProgram &prog) const;
+
+    /**
+     * Does this subtree read a stat that was filtered out, and so has no
+     * storage and always reads as zero?
+     */
+    virtual bool readsFiltered() const { return false; }
+
     virtual ~Node() {};
 };
 
@@ -2095,10 +2910,14 @@ class ScalarStatNode : public Node
 {
   private:
     const ScalarInfo *data;
+    /** Set for a Scalar, whose storage a program can read directly */
+    const Scalar *scalar;
     mutable VResult vresult;
 
   public:
-    ScalarStatNode(const ScalarInfo *d) : data(d), vresult(1) {}
+    ScalarStatNode(const ScalarInfo *d, const Scalar *s = nullptr)
+        : data(d), scalar(s), vresult(1)
+    {}
 
     const VResult &
     result() const
@@ -2115,6 +2934,8 @@ class ScalarStatNode : public Node
      *
      */
     std::string str() const { return data->name; }
+
+    off_type compile(FormulaProgram &prog) const override;
 };
 
 template <class Stat>
@@ -2156,21 +2977,35 @@ class ScalarProxyNode : public Node
     {
         return proxy.str();
     }
+
+    bool readsFiltered() const override { return proxy.isFiltered(); }
 };
 
 class VectorStatNode : public Node
 {
   private:
     const VectorInfo *data;
+    /** Set for a Vector, whose storage a program can read directly */
+    const Vector *vector;
 
   public:
-    VectorStatNode(const VectorInfo *d) : data(d) { }
+    VectorStatNode(const VectorInfo *d, const Vector *v = nullptr)
+        : data(d), vector(v)
+    { }
     const VResult &result() const { return data->result(); }
     Result total() const { return data->total(); };
 
     size_type size() const { return data->size(); }
 
     std::string str() const { return data->name; }
+
+    off_type compile(FormulaProgram &prog) const override;
+
+    bool
+    readsFiltered() const override
+    {
+        return data->flags.isSet(filtered);
+    }
 };
 
 template <class T>
@@ -2185,6 +3020,12 @@ class ConstNode : public Node
     Result total() const { return vresult[0]; };
     size_type size() const { return 1; }
     std::string str() const { return std::to_string(vresult[0]); }
+
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        return prog.operand(vresult.data(), vresult.size());
+    }
 };
 
 template <class T>
@@ -2218,6 +3059,12 @@ class ConstVectorNode : public Node
         tmp += ")";
         return tmp;
     }
+
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        return prog.operand(vresult.data(), vresult.size());
+    }
 };
 
 template <class Op>
@@ -2302,6 +3149,16 @@ class UnaryNode : public Node
     {
         return OpString<Op>::str() + l->str();
     }
+
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        if (ProgramOp<Op>::code == FormulaProgram::Call)
+            return Node::compile(prog);
+        return prog.unary(ProgramOp<Op>::code, l->compile(prog));
+    }
+
+    bool readsFiltered() const override { return l->readsFiltered(); }
 };
 
 template <class Op>
@@ -2399,6 +3256,22 @@ class BinaryNode : public Node
     {
         return csprintf("(%s %s %s)", l->str(), OpString<Op>::str(), r->str());
     }
+
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        if (ProgramOp<Op>::code == FormulaProgram::Call)
+            return Node::compile(prog);
+        off_type a = l->compile(prog);
+        off_type b = r->compile(prog);
+        return prog.binary(ProgramOp<Op>::code, a, b);
+    }
+
+    bool
+    readsFiltered() const override
+    {
+        return l->readsFiltered() || r->readsFiltered();
+    }
 };
 
 template <class Op>
@@ -2450,6 +3323,16 @@ class SumNode : public Node
     {
         return csprintf("total(%s)", l->str());
     }
+
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        if (ProgramOp<Op>::code != FormulaProgram::Add)
+            return Node::compile(prog);
+        return prog.unary(FormulaProgram::Sum, l->compile(prog));
+    }
+
+    bool readsFiltered() const override { return l->readsFiltered(); }
 };
 
 
@@ -2472,6 +3355,9 @@ class Scalar : public ScalarBase<Scalar, StatStor>
 {
   public:
     using ScalarBase<Scalar, StatStor>::operator=;
+
+    /** The value of this stat, for compiled formulas. */
+    const Counter *valuePtr() const { return data()->valuePtr(); }
 };
 
 /**
@@ -2494,6 +3380,19 @@ class Value : public ValueBase<Value>
  */
 class Vector : public VectorBase<Vector, StatStor>
 {
+  public:
+    /**
+     * The values of this stat, for compiled formulas. The storage of a
+     * Vector is a plain array of counters.
+     */
+    const Counter *
+    valuePtr() const
+    {
+        static_assert(sizeof(StatStor) == sizeof(Counter),
+                      "StatStor must hold just a Counter");
+        refresh();
+        return storage ? storage->valuePtr() : nullptr;
+    }
 };
 
 /**
@@ -2563,6 +3462,115 @@ class Histogram : public DistBase<Histogram, HistStor>
     }
 };
 
+/**
+ * A Scalar that can be updated from several simulation threads.
+ * @sa Stat, ScalarBase, ShardedStor
+ */
+class ShardedScalar : public ScalarBase<ShardedScalar, ShardedStor<StatStor> >
+{
+  public:
+    using ScalarBase<ShardedScalar, ShardedStor<StatStor> >::operator=;
+};
+
+/**
+ * A Vector that can be updated from several simulation threads.
+ * @sa Stat, VectorBase, ShardedStor
+ */
+class ShardedVector : public VectorBase<ShardedVector, ShardedStor<StatStor> >
+{
+};
+
+/**
+ * A Distribution that can be updated from several simulation threads.
+ * @sa Stat, DistBase, ShardedStor
+ */
+class ShardedDistribution
+    : public DistBase<ShardedDistribution, ShardedStor<DistStor> >
+{
+  public:
+    /**
+     * Set the parameters of this distribution. @sa Distribution::init
+     */
+    ShardedDistribution &
+    init(Counter min, Counter max, Counter bkt)
+    {
+        DistStor::Params *params = new DistStor::Params;
+        params->min = min;
+        params->max = max;
+        params->bucket_size = bkt;
+        params->buckets = (size_type)ceil((max - min + 1.0) / bkt);
+        this->setParams(params);
+        this->doInit();
+        return this->self();
+    }
+};
+
+/**
+ * A Histogram that can be updated from several simulation threads.
+ * @sa Stat, DistBase, ShardedStor
+ */
+class ShardedHistogram
+    : public DistBase<ShardedHistogram, ShardedStor<HistStor> >
+{
+  public:
+    /**
+     * Set the parameters of this histogram. @sa Histogram::init
+     */
+    ShardedHistogram &
+    init(size_type size)
+    {
+        HistStor::Params *params = new HistStor::Params;
+        params->buckets = size;
+        this->setParams(params);
+        this->doInit();
+        return this->self();
+    }
+};
+
+/**
+ * A histogram with log-linear buckets, for values such as latencies that
+ * span several orders of magnitude.
+ * @sa Stat, DistBase, LogHistStor
+ */
+class LogHistogram : public DistBase<LogHistogram, LogHistStor>
+{
+  public:
+    /**
+     * Set the parameters of this histogram. @sa LogHistStor::Params
+     * @param max The maximum value of the histogram.
+     * @param bits The log2 of the number of buckets for each power of
+     * two, which bounds the relative error to 2^-bits.
+     * @return A reference to this histogram.
+     */
+    LogHistogram &
+    init(Counter max, unsigned bits = 7)
+    {
+        this->setParams(new LogHistStor::Params(max, bits));
+        this->doInit();
+        return this->self();
+    }
+};
+
+/**
+ * A LogHistogram that can be sampled from several simulation threads.
+ * @sa Stat, DistBase, ShardedStor
+ */
+class ShardedLogHistogram
+    : public DistBase<ShardedLogHistogram, ShardedStor<LogHistStor> >
+{
+  public:
+    /**
+     * Set the parameters of this histogram. @sa LogHistogram::init
+     */
+    ShardedLogHistogram &
+    init(Counter max, unsigned bits = 7)
+    {
+        this->setParams(new LogHistStor::Params(max, bits));
+        this->doInit();
+        return this->self();
+    }
+};
+
 /**
  * Calculates the mean and variance of all the samples.
  * @sa DistBase, SampleStor
@@ -2696,6 +3704,14 @@ class FormulaInfoProxy : public InfoProxy<Stat, FormulaInfo>
     VCounter &value() const { return cvec; }
 
     std::string str() const { return this->s.str(); }
+    bool readsFiltered() const override { return this->s.readsFiltered(); }
+
+    void
+    enable() override
+    {
+        FormulaInfo::enable();
+        this->s.compile();
+    }
 };
 
 template <class Stat>
@@ -2729,6 +3745,7 @@ class SparseHistBase : public DataWrap<Derived, SparseHistInfoProxy>
     Storage *
     data()
     {
+        this->refresh();
         return reinterpret_cast<Storage *>(storage);
     }
 
@@ -2739,6 +3756,7 @@ class SparseHistBase : public DataWrap<Derived, SparseHistInfoProxy>
     const Storage *
     data() const
     {
+        this->refresh();
         return reinterpret_cast<const Storage *>(storage);
     }
 
@@ -2785,6 +3803,7 @@ class SparseHistBase : public DataWrap<Derived, SparseHistInfoProxy>
     void
     reset()
     {
+        this->startReset();
         data()->reset(this->info());
     }
 };
@@ -2894,6 +3913,12 @@ class Formula : public DataWrapVec<Formula, FormulaInfoProxy>
     /** The root of the tree which represents the Formula */
     NodePtr root;
     friend class Temp;
+    friend class FormulaNode;
+
+    /** The flattened tree, set by compile() */
+    std::shared_ptr<FormulaProgram> program;
+    /** The operand of program that holds the result */
+    off_type programResult;
 
   public:
     /**
@@ -2968,6 +3993,15 @@ class Formula : public DataWrapVec<Formula, FormulaInfoProxy>
     bool zero() const;
 
     std::string str() const;
+
+    /**
+     * Flatten the tree into a FormulaProgram. Called when the stats are
+     * enabled, after which the stats the formula reads don't move.
+     */
+    void compile();
+
+    /** Does the formula read a stat that was filtered out? */
+    bool readsFiltered() const { return root && root->readsFiltered(); }
 };
 
 class FormulaNode : public Node
@@ -2984,6 +4018,16 @@ class FormulaNode : public Node
     Result total() const { return formula.total(); }
 
     std::string str() const { return formula.str(); }
+
+    /** Inline the other formula's tree. */
+    off_type
+    compile(FormulaProgram &prog) const override
+    {
+        return formula.root ? formula.root->compile(prog) :
+            Node::compile(prog);
+    }
+
+    bool readsFiltered() const override { return formula.readsFiltered(); }
 };
 
 /**
@@ -3023,7 +4067,7 @@ class Temp
      * @param s The ScalarStat to place in a node.
      */
     Temp(const Scalar &s)
-        : node(new ScalarStatNode(s.info()))
+        : node(new ScalarStatNode(s.info(), &s))
     { }
 
     /**
@@ -3047,7 +4091,7 @@ class Temp
      * @param s The VectorStat to place in a node.
      */
     Temp(const Vector &s)
-        : node(new VectorStatNode(s.info()))
+        : node(new VectorStatNode(s.info(), &s))
     { }
 
     Temp(const AverageVector &s)
@@ -3225,6 +4269,14 @@ sum(Temp val)
 /** Dump all statistics data to the registered outputs */
 void dump();
 void reset();
+
+/**
+ * Reset the storage of all statistics. This takes constant time: it
+ * starts a new reset generation, and every stat resets itself when it
+ * is next updated, read or prepared for dumping. Only sharded stats
+ * are reset right away.
+ */
+void resetAll();
 void enable();
 bool enabled();
 
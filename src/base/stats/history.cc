@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/history.hh"
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+
+#include "base/callback.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "base/statistics.hh"
+#include "sim/core.hh"
+
+namespace Stats {
+
+History::History(const std::string &file_name,
+                 const std::vector<std::string> &_select, uint32_t samples,
+                 Tick interval)
+    : Sampler(_select, interval), fileName(file_name), numSamples(samples),
+      taken(0), lastGeneration(0)
+{
+    fatal_if(!numSamples, "A stats history needs at least one sample\n");
+}
+
+void
+History::setup()
+{
+    ring.resize(values.size() * numSamples);
+    ringTicks.resize(numSamples);
+    last.assign(values.size(), 0.0);
+    lastGeneration = resetGeneration;
+}
+
+size_t
+History::slot(size_t i) const
+{
+    return (taken - size() + i) % numSamples;
+}
+
+size_t
+History::size() const
+{
+    return std::min<uint64_t>(taken, numSamples);
+}
+
+std::vector<Tick>
+History::ticks() const
+{
+    std::vector<Tick> result;
+    for (size_t i = 0; i < size(); i++)
+        result.push_back(ringTicks[slot(i)]);
+    return result;
+}
+
+std::vector<double>
+History::series(const std::string &name) const
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end())
+        return std::vector<double>();
+
+    const size_t value = it - names.begin();
+    std::vector<double> result;
+    for (size_t i = 0; i < size(); i++)
+        result.push_back(ring[slot(i) * names.size() + value]);
+    return result;
+}
+
+std::vector<double>
+History::window(size_t i) const
+{
+    if (i >= size())
+        return std::vector<double>();
+
+    auto first = ring.begin() + slot(i) * names.size();
+    return std::vector<double>(first, first + names.size());
+}
+
+void
+History::end()
+{
+    // Counters start again from zero when the stats are reset, which
+    // loses whatever they counted in this window before the reset.
+    if (lastGeneration != resetGeneration) {
+        std::fill(last.begin(), last.end(), 0.0);
+        lastGeneration = resetGeneration;
+    }
+
+    const size_t n = values.size();
+    double *sample = ring.data() + (taken % numSamples) * n;
+    for (size_t i = 0; i < n; i++) {
+        sample[i] = counts[i] ? values[i] - last[i] : values[i];
+        last[i] = values[i];
+    }
+    ringTicks[taken % numSamples] = curTick();
+    taken++;
+}
+
+void
+History::write()
+{
+    // Catch what happened since the last sample
+    if (!taken || ringTicks[(taken - 1) % numSamples] != curTick())
+        sample();
+
+    OutputStream *file = simout.create(fileName);
+    std::ostream &os = *file->stream();
+
+    const size_t n = names.size();
+    os << "# " << size() << " samples of " << n << " values, oldest"
+       << " first. Counters are the change in the window up to each"
+       << " tick, other values are their value at that tick.\n";
+    os.precision(12);
+    os << "tick";
+    for (Tick tick : ticks())
+        os << " " << tick;
+    os << "\n";
+    for (size_t value = 0; value < n; value++) {
+        os << names[value];
+        for (size_t i = 0; i < size(); i++)
+            os << " " << ring[slot(i) * n + value];
+        os << "\n";
+    }
+
+    simout.close(file);
+}
+
+History *
+initHistory(const std::string &filename,
+            const std::vector<std::string> &select, uint32_t samples,
+            Tick interval)
+{
+    History *history = new History(filename, select, samples, interval);
+    registerExitCallback(new MakeCallback<History, &History::write>(
+                             history));
+    return history;
+}
+
+} // namespace Stats
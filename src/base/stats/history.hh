@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_HISTORY_HH__
+#define __BASE_STATS_HISTORY_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/stats/sampler.hh"
+#include "base/types.hh"
+
+namespace Stats {
+
+/**
+ * Keeps a bounded history of selected statistics in memory, for phase
+ * analysis without a dump and a reset for every interval. A sample is
+ * taken every interval ticks with periodicStatSample(), and holds the
+ * change of each value since the previous sample, so that a counter
+ * reads as what happened in that window. Formulas and the means of
+ * distributions aren't counters, and hold their value at the end of
+ * the window instead. Once the ring of samples is full the oldest one
+ * is dropped for every new one.
+ *
+ * The history can be read while the simulation runs, and is written
+ * to a file in a columnar format when the simulator exits: a line of
+ * sample ticks, then a line for each value with its samples, oldest
+ * first.
+ */
+class History : public Sampler
+{
+  protected:
+    const std::string fileName;
+    const uint32_t numSamples;
+
+    /** The samples, each values.size() doubles, and their ticks */
+    std::vector<double> ring;
+    std::vector<Tick> ringTicks;
+    /** Number of samples taken so far */
+    uint64_t taken;
+
+    /** Values at the previous sample, and its reset generation */
+    std::vector<double> last;
+    uint64_t lastGeneration;
+
+    void setup() override;
+
+    /** Where sample i, counting from the oldest one, is in the ring */
+    size_t slot(size_t i) const;
+
+  public:
+    History(const std::string &file_name,
+            const std::vector<std::string> &select, uint32_t samples,
+            Tick interval);
+
+    /** Number of samples in the history */
+    size_t size() const;
+    /** Names of the sampled values */
+    const std::vector<std::string> &valueNames() const { return names; }
+    /** Ticks of the samples in the history, oldest first */
+    std::vector<Tick> ticks() const;
+    /** The history of one value, oldest first */
+    std::vector<double> series(const std::string &name) const;
+    /** The values of sample i, counting from the oldest one */
+    std::vector<double> window(size_t i) const;
+
+    /** Write the history out, after taking a last sample */
+    void write();
+
+    // Implement Output
+    /** Samples are only taken by sample(), not when stats are dumped */
+    bool valid() const override { return false; }
+    void end() override;
+};
+
+History *initHistory(const std::string &filename,
+                     const std::vector<std::string> &select,
+                     uint32_t samples, Tick interval);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_HISTORY_HH__
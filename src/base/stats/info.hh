@@ -31,6 +31,9 @@
 #ifndef __BASE_STATS_INFO_HH__
 #define __BASE_STATS_INFO_HH__
 
+#include <utility>
+#include <vector>
+
 #include "base/stats/types.hh"
 #include "base/flags.hh"
 
@@ -45,6 +48,8 @@ const FlagsType none =          0x0000;
 const FlagsType init =          0x0001;
 /** Print this stat. */
 const FlagsType display =       0x0002;
+/** This stat didn't pass the filter, and has no storage. */
+const FlagsType filtered =      0x0004;
 /** Print the total. */
 const FlagsType total =         0x0010;
 /** Print the percent of the total that this entry represents. */
@@ -61,7 +66,7 @@ const FlagsType nonan =         0x0200;
 const FlagsType oneline =       0x0400;
 
 /** Mask of flags that can't be set directly */
-const FlagsType __reserved =    init | display;
+const FlagsType __reserved =    init | display | filtered;
 
 struct StorageParams;
 struct Output;
@@ -87,6 +92,11 @@ class Info
      */
     static int id_count;
     int id;
+    /**
+     * Whether the values only count up between resets, as opposed to
+     * levels, means or rates. Set from the storage of the stat.
+     */
+    bool counter;
 
   public:
     const StorageParams *storageParams;
@@ -169,7 +179,7 @@ class VectorInfo : public Info
     virtual Result total() const = 0;
 };
 
-enum DistType { Deviation, Dist, Hist };
+enum DistType { Deviation, Dist, Hist, LogHist };
 
 struct DistData
 {
@@ -187,6 +197,15 @@ struct DistData
     Counter squares;
     Counter logs;
     Counter samples;
+
+    /**
+     * For a LogHist, the range of values of each bucket in cvec. Buckets
+     * that are empty are left out.
+     */
+    VCounter bucket_low;
+    VCounter bucket_high;
+    /** For a LogHist, the value at each reported percentile. */
+    std::vector<std::pair<Result, Counter> > percentiles;
 };
 
 class DistInfo : public Info
@@ -237,6 +256,8 @@ class FormulaInfo : public VectorInfo
 {
   public:
     virtual std::string str() const = 0;
+    /** Does the formula read a stat that was filtered out? */
+    virtual bool readsFiltered() const = 0;
 };
 
 /** Data structure of sparse histogram */
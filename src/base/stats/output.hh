@@ -52,6 +52,14 @@ struct Output
     virtual void end() = 0;
     virtual bool valid() const = 0;
 
+    /** Get ready for the simulator to fork, stopping any threads */
+    virtual void preFork() { }
+    /**
+     * Carry on after the simulator forked. The child gets a copy of
+     * everything the parent had, apart from its threads.
+     */
+    virtual void postFork(bool child) { }
+
     virtual void visit(const ScalarInfo &info) = 0;
     virtual void visit(const VectorInfo &info) = 0;
     virtual void visit(const DistInfo &info) = 0;
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/sampler.hh"
+
+#include "base/statistics.hh"
+#include "base/stats/info.hh"
+
+namespace Stats {
+
+namespace
+{
+
+std::string
+elementName(const std::string &name, const std::vector<std::string> &subnames,
+            size_type i)
+{
+    if (i < subnames.size() && !subnames[i].empty())
+        return name + "::" + subnames[i];
+    return name + "::" + std::to_string(i);
+}
+
+} // anonymous namespace
+
+Sampler::Sampler(const std::vector<std::string> &_select, Tick interval)
+    : selectAll(_select.empty()), laidOut(false), layingOut(false),
+      cursor(0), _interval(interval)
+{
+    select.setExpression(_select);
+}
+
+void
+Sampler::layout()
+{
+    std::lock_guard<std::mutex> lock(namesLock);
+
+    layingOut = true;
+    for (auto *info : statsList()) {
+        if (!(info->flags & display))
+            continue;
+        if (!selectAll && !select.match(info->name))
+            continue;
+
+        offsets[info] = names.size();
+        infos.push_back(info);
+        // Averages can only be read once they're prepared
+        info->prepare();
+        info->visit(*this);
+    }
+    layingOut = false;
+
+    values.resize(names.size());
+    setup();
+    laidOut = true;
+}
+
+bool
+Sampler::start(const Info &info)
+{
+    if (layingOut)
+        return true;
+
+    if (!laidOut)
+        layout();
+
+    auto it = offsets.find(&info);
+    if (it == offsets.end())
+        return false;
+
+    cursor = it->second;
+    return true;
+}
+
+void
+Sampler::put(const std::string &name, double value, bool count)
+{
+    if (layingOut) {
+        names.push_back(name);
+        counts.push_back(count);
+    } else if (cursor < values.size()) {
+        values[cursor++] = value;
+    }
+}
+
+void
+Sampler::putDist(const std::string &name, const DistData &data)
+{
+    put(name + "::samples", data.samples);
+    put(name + "::mean", data.samples ? data.sum / data.samples : 0.0,
+        false);
+}
+
+void
+Sampler::sample()
+{
+    if (!laidOut)
+        layout();
+
+    begin();
+    for (auto *info : infos) {
+        info->prepare();
+        info->visit(*this);
+    }
+    end();
+}
+
+void
+Sampler::visit(const ScalarInfo &info)
+{
+    if (!start(info))
+        return;
+
+    put(info.name, info.result(), info.counter);
+}
+
+void
+Sampler::putVector(const VectorInfo &info, bool count)
+{
+    // Like the text output, name vectors of one element like scalars
+    const VResult &result = info.result();
+    if (info.size() == 1 &&
+            (info.subnames.empty() || info.subnames[0].empty())) {
+        put(info.name, result.empty() ? 0.0 : result[0], count);
+        return;
+    }
+
+    for (size_type i = 0; i < info.size(); i++) {
+        put(elementName(info.name, info.subnames, i),
+            i < result.size() ? result[i] : 0.0, count);
+    }
+
+    if (info.flags & total)
+        put(info.name + "::total", info.total(), count);
+}
+
+void
+Sampler::visit(const VectorInfo &info)
+{
+    if (start(info))
+        putVector(info, info.counter);
+}
+
+void
+Sampler::visit(const DistInfo &info)
+{
+    if (!start(info))
+        return;
+
+    putDist(info.name, info.data);
+}
+
+void
+Sampler::visit(const VectorDistInfo &info)
+{
+    if (!start(info))
+        return;
+
+    for (size_type i = 0; i < info.size(); i++)
+        putDist(elementName(info.name, info.subnames, i), info.data[i]);
+}
+
+void
+Sampler::visit(const Vector2dInfo &info)
+{
+    if (!start(info))
+        return;
+
+    for (size_type x = 0; x < info.x; x++) {
+        const std::string row = elementName(info.name, info.subnames, x);
+        for (size_type y = 0; y < info.y; y++) {
+            const size_type i = x * info.y + y;
+            put(elementName(row, info.y_subnames, y),
+                i < info.cvec.size() ? info.cvec[i] : 0.0, info.counter);
+        }
+    }
+}
+
+void
+Sampler::visit(const FormulaInfo &info)
+{
+    if (start(info))
+        putVector(info, false);
+}
+
+void
+Sampler::visit(const SparseHistInfo &info)
+{
+    if (!start(info))
+        return;
+
+    put(info.name + "::samples", info.data.samples);
+}
+
+void
+Sampler::begin()
+{
+}
+
+} // namespace Stats
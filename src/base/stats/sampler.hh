@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_SAMPLER_HH__
+#define __BASE_STATS_SAMPLER_HH__
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/match.hh"
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+#include "base/types.hh"
+
+namespace Stats {
+
+struct DistData;
+class Info;
+class VectorInfo;
+
+/**
+ * Base class for outputs that take samples of selected statistics, as
+ * opposed to dumping all of them. The values of the selected stats are
+ * flattened into a vector of doubles, which is handed to end() every
+ * time a sample is taken. Vectors give a value per element, and
+ * distributions their number of samples and their mean.
+ *
+ * The values are laid out, and named, the first time a sample is
+ * taken, by which time all stats have been registered.
+ */
+class Sampler : public Output
+{
+  protected:
+    ObjectMatch select;
+    bool selectAll;
+
+    /** Stats being sampled and where their values start */
+    std::vector<Info *> infos;
+    std::unordered_map<const Info *, size_t> offsets;
+    /** Held while the names are laid out */
+    std::mutex namesLock;
+    std::vector<std::string> names;
+    /**
+     * Whether each value counts up over time, rather than being a
+     * level, a ratio or a mean. Scalars and vectors say which they are
+     * with Info::counter; formulas and means of distributions never
+     * count.
+     */
+    std::vector<bool> counts;
+    bool laidOut;
+    /** Set while layout() visits the stats to name their values */
+    bool layingOut;
+
+    /** Values of the sample being taken */
+    std::vector<double> values;
+    size_t cursor;
+
+    std::atomic<Tick> _interval;
+
+    void layout();
+    /** Called once the values have been laid out */
+    virtual void setup() { }
+    /** Find where the values of a stat go, if it's sampled */
+    bool start(const Info &info);
+    void put(const std::string &name, double value, bool count = true);
+    void putDist(const std::string &name, const DistData &data);
+    void putVector(const VectorInfo &info, bool count);
+
+  public:
+    Sampler(const std::vector<std::string> &select, Tick interval);
+
+    /** Ticks between periodic samples, 0 when there are none */
+    Tick interval() const { return _interval; }
+
+    /** Prepare the selected stats and take a sample of them */
+    void sample();
+
+    // Implement Visit
+    void visit(const ScalarInfo &info) override;
+    void visit(const VectorInfo &info) override;
+    void visit(const DistInfo &info) override;
+    void visit(const VectorDistInfo &info) override;
+    void visit(const Vector2dInfo &info) override;
+    void visit(const FormulaInfo &info) override;
+    void visit(const SparseHistInfo &info) override;
+
+    // Implement Output
+    void begin() override;
+};
+
+} // namespace Stats
+
+#endif // __BASE_STATS_SAMPLER_HH__
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/shm.hh"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <sstream>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
+
+namespace Stats {
+
+namespace
+{
+
+const char shmMagic[8] = { 'G', 'E', 'M', '5', 'S', 'H', 'M', 0 };
+const uint32_t shmVersion = 1;
+
+struct SampleHeader
+{
+    std::atomic<uint64_t> seq;
+    uint64_t tick;
+};
+
+} // anonymous namespace
+
+SharedMemory::SharedMemory(const std::string &name,
+                           const std::string &socket_path,
+                           const std::vector<std::string> &_select,
+                           uint32_t samples, Tick interval)
+    : Sampler(_select, interval), shmName("/" + name),
+      socketPath(socket_path), numSamples(samples), owner(getpid()),
+      header(nullptr), mapSize(0), listenFd(-1)
+{
+    fatal_if(name.empty() || name.find('/') != std::string::npos,
+             "Invalid shared memory stats name '%s'\n", name);
+    fatal_if(!numSamples, "Shared memory stats need at least one sample\n");
+
+    listen();
+    startControl();
+}
+
+SharedMemory::~SharedMemory()
+{
+    // A process forked behind our back has none of our threads, and
+    // must leave the socket and the shared memory to their owner.
+    if (getpid() != owner) {
+        abandon();
+        return;
+    }
+
+    stopControl();
+
+    close(stopPipe[0]);
+    close(stopPipe[1]);
+    close(listenFd);
+    unlink(socketPath.c_str());
+
+    if (header) {
+        header->~Header();
+        munmap(header, mapSize);
+        shm_unlink(shmName.c_str());
+    }
+}
+
+void
+SharedMemory::listen()
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    fatal_if(socketPath.size() >= sizeof(addr.sun_path),
+             "Stats control socket path %s is too long\n", socketPath);
+    strcpy(addr.sun_path, socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    fatal_if(listenFd < 0, "Can't create stats control socket: %s\n",
+             strerror(errno));
+    unlink(socketPath.c_str());
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+            ::listen(listenFd, 4) < 0) {
+        fatal("Can't listen on stats control socket %s: %s\n",
+              socketPath, strerror(errno));
+    }
+
+    fatal_if(pipe(stopPipe) < 0, "Can't create pipe: %s\n", strerror(errno));
+}
+
+void
+SharedMemory::startControl()
+{
+    control.reset(new std::thread(&SharedMemory::controlLoop, this));
+}
+
+void
+SharedMemory::stopControl()
+{
+    if (!control)
+        return;
+
+    char stop = 0;
+    if (write(stopPipe[1], &stop, 1) == 1) {
+        control->join();
+        // Take the byte back so that the next thread doesn't stop
+        fatal_if(read(stopPipe[0], &stop, 1) != 1,
+                 "Can't read the stats control pipe: %s\n",
+                 strerror(errno));
+    } else {
+        control->detach();
+    }
+    control.reset();
+}
+
+void
+SharedMemory::abandon()
+{
+    // The thread only exists in the owner, so its handle is dropped
+    // without being joined or detached.
+    control.release();
+
+    close(stopPipe[0]);
+    close(stopPipe[1]);
+    close(listenFd);
+    listenFd = -1;
+
+    if (header) {
+        munmap(header, mapSize);
+        header = nullptr;
+    }
+}
+
+void
+SharedMemory::preFork()
+{
+    // The thread may hold namesLock, which the child could never take
+    stopControl();
+}
+
+void
+SharedMemory::postFork(bool child)
+{
+    if (child) {
+        abandon();
+        owner = getpid();
+
+        shmName = csprintf("%s.%d", shmName, owner);
+        const size_t slash = socketPath.rfind('/');
+        socketPath = simout.resolve(slash == std::string::npos ?
+            socketPath : socketPath.substr(slash + 1));
+
+        listen();
+        if (laidOut)
+            setup();
+    }
+
+    startControl();
+}
+
+void
+SharedMemory::setup()
+{
+    const size_t sample_size =
+        sizeof(SampleHeader) + values.size() * sizeof(double);
+    mapSize = sizeof(Header) + sample_size * numSamples;
+
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    fatal_if(fd < 0, "Can't create shared memory %s: %s\n", shmName,
+             strerror(errno));
+    fatal_if(ftruncate(fd, mapSize) < 0,
+             "Can't size shared memory %s: %s\n", shmName, strerror(errno));
+    void *map = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+    close(fd);
+    fatal_if(map == MAP_FAILED, "Can't map shared memory %s: %s\n",
+             shmName, strerror(errno));
+
+    header = new (map) Header;
+    memcpy(header->magic, shmMagic, sizeof(shmMagic));
+    header->version = shmVersion;
+    header->numValues = values.size();
+    header->numSamples = numSamples;
+    header->sampleSize = sample_size;
+    header->tickFrequency = SimClock::Frequency;
+    header->published = 0;
+}
+
+bool
+SharedMemory::valid() const
+{
+    return listenFd >= 0;
+}
+
+void
+SharedMemory::end()
+{
+    if (!header || getpid() != owner)
+        return;
+
+    const uint64_t n = header->published.load(std::memory_order_relaxed);
+    char *sample =
+        (char *)(header + 1) + (n % numSamples) * header->sampleSize;
+    SampleHeader *sample_header = (SampleHeader *)sample;
+
+    sample_header->seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sample_header->tick = curTick();
+    memcpy(sample + sizeof(SampleHeader), values.data(),
+           values.size() * sizeof(double));
+    sample_header->seq.store(2 * n + 2, std::memory_order_release);
+
+    header->published.store(n + 1, std::memory_order_release);
+}
+
+std::string
+SharedMemory::command(const std::string &line)
+{
+    std::istringstream in(line);
+    std::ostringstream out;
+    std::string cmd;
+    in >> cmd;
+
+    if (cmd == "names") {
+        std::lock_guard<std::mutex> lock(namesLock);
+        out << names.size() << "\n";
+        for (const auto &name : names)
+            out << name << "\n";
+    } else if (cmd == "info") {
+        std::lock_guard<std::mutex> lock(namesLock);
+        out << "shm " << shmName << " values " << names.size()
+            << " samples " << numSamples << " ready " << laidOut << "\n";
+    } else if (cmd == "interval") {
+        Tick interval;
+        if (!(in >> interval)) {
+            out << _interval << "\n";
+        } else if (!_interval) {
+            out << "error periodic publishing is off\n";
+        } else if (!interval) {
+            out << "error interval must be positive\n";
+        } else {
+            _interval = interval;
+            out << "ok\n";
+        }
+    } else {
+        out << "error unknown command '" << cmd << "'\n";
+    }
+
+    return out.str();
+}
+
+void
+SharedMemory::controlLoop()
+{
+    // Clients are served one at a time until they hang up
+    while (true) {
+        pollfd fds[2] = {
+            { listenFd, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[1].revents)
+            return;
+
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+
+        std::string pending;
+        while (true) {
+            pollfd cfds[2] = { { fd, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+            if (poll(cfds, 2, -1) < 0 && errno != EINTR)
+                break;
+            if (cfds[1].revents) {
+                close(fd);
+                return;
+            }
+            if (!cfds[0].revents)
+                continue;
+
+            char buf[256];
+            ssize_t len = read(fd, buf, sizeof(buf));
+            if (len <= 0)
+                break;
+            pending.append(buf, len);
+
+            size_t eol;
+            bool ok = true;
+            while (ok && (eol = pending.find('\n')) != std::string::npos) {
+                const std::string reply = command(pending.substr(0, eol));
+                pending.erase(0, eol + 1);
+                ok = write(fd, reply.data(), reply.size()) ==
+                    (ssize_t)reply.size();
+            }
+            if (!ok)
+                break;
+        }
+        close(fd);
+    }
+}
+
+SharedMemory *
+initSharedMemory(const std::string &name,
+                 const std::vector<std::string> &select, uint32_t samples,
+                 Tick interval)
+{
+    // Destroyed at exit, which removes the socket and shared memory
+    static std::vector<std::unique_ptr<SharedMemory>> outputs;
+
+    outputs.emplace_back(new SharedMemory(name,
+        simout.resolve(name + ".sock"), select, samples, interval));
+    return outputs.back().get();
+}
+
+} // namespace Stats
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_SHM_HH__
+#define __BASE_STATS_SHM_HH__
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/stats/sampler.hh"
+#include "base/types.hh"
+
+namespace Stats {
+
+/**
+ * Publishes selected statistics to a POSIX shared memory object, so
+ * that a viewer on the same host can follow a simulation as it runs.
+ * Stats are published every time they are dumped, and can also be
+ * published every interval ticks with periodicStatSample().
+ *
+ * The shared memory holds a SharedMemoryHeader followed by a ring of
+ * samples. Each sample is a 64-bit sequence number, the tick it was
+ * taken at, and a double for each published value. Sample n lives in
+ * slot n % samples, and its sequence number is 2n+1 while it is being
+ * written and 2n+2 once it is complete, so a reader can tell a torn
+ * sample apart from a whole one.
+ *
+ * A UNIX socket next to the other outputs serves simple line based
+ * commands: "names" lists the published values in order, "info"
+ * describes the shared memory, and "interval [ticks]" gets or sets the
+ * publishing interval.
+ *
+ * When the simulator forks, the child publishes to a shared memory
+ * object of its own, named after the parent's with the pid of the child
+ * appended, and listens on a socket in its own output directory.
+ */
+class SharedMemory : public Sampler
+{
+  public:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numValues;
+        uint32_t numSamples;
+        uint32_t sampleSize;
+        uint64_t tickFrequency;
+        /** Number of samples written so far */
+        std::atomic<uint64_t> published;
+    };
+
+  protected:
+    std::string shmName;
+    std::string socketPath;
+    const uint32_t numSamples;
+
+    /** The process the socket and the shared memory belong to */
+    pid_t owner;
+
+    Header *header;
+    size_t mapSize;
+
+    int listenFd;
+    int stopPipe[2];
+    std::unique_ptr<std::thread> control;
+
+    /** Create the shared memory once the values are laid out */
+    void setup() override;
+
+    /** Open the control socket and start serving it */
+    void listen();
+    void startControl();
+    void stopControl();
+    /**
+     * Let go of the descriptors and the mapping inherited from the
+     * process that owns them, without removing them.
+     */
+    void abandon();
+
+    void controlLoop();
+    std::string command(const std::string &line);
+
+  public:
+    SharedMemory(const std::string &name, const std::string &socket_path,
+                 const std::vector<std::string> &select,
+                 uint32_t samples, Tick interval);
+    ~SharedMemory();
+
+    // Implement Output
+    bool valid() const override;
+    void end() override;
+    void preFork() override;
+    void postFork(bool child) override;
+};
+
+SharedMemory *initSharedMemory(const std::string &name,
+                               const std::vector<std::string> &select,
+                               uint32_t samples, Tick interval);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_SHM_HH__
@@ -46,10 +46,15 @@
 #include "base/stats/text.hh"
 
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include "base/cast.hh"
 #include "base/logging.hh"
@@ -84,19 +89,115 @@ namespace Stats {
 
 std::list<Info *> &statsList();
 
+/**
+ * Formats and writes dumps on a background thread. A dump is handed
+ * over as a list of print objects, which hold copies of the values they
+ * print, so the stats can change as soon as the dump has been handed
+ * over. At most depth dumps wait to be written; further dumps block
+ * until the thread catches up.
+ */
+class Text::Writer
+{
+  public:
+    typedef std::vector<std::function<void(ostream &)> > Dump;
+
+  private:
+    ostream &stream;
+    const unsigned depth;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Dump> queue;
+    /** Set while the thread is writing a dump it took off the queue */
+    bool busy;
+    bool stopping;
+    /** Whether the stream was still good after the last dump */
+    bool good;
+
+    std::thread thread;
+
+    void
+    loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+
+            Dump dump(std::move(queue.front()));
+            queue.pop_front();
+            busy = true;
+            changed.notify_all();
+
+            lock.unlock();
+            for (auto &print : dump)
+                print(stream);
+            stream.flush();
+            lock.lock();
+
+            busy = false;
+            good = stream.good();
+            changed.notify_all();
+        }
+    }
+
+  public:
+    Writer(ostream &_stream, unsigned _depth)
+        : stream(_stream), depth(_depth), busy(false), stopping(false),
+          good(true), thread(&Writer::loop, this)
+    {
+        assert(depth > 0);
+    }
+
+    ~Writer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        thread.join();
+    }
+
+    void
+    push(Dump &&dump)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]{ return queue.size() < depth; });
+        queue.push_back(std::move(dump));
+        changed.notify_all();
+    }
+
+    /** Wait until every dump handed over has been written. */
+    void
+    drain()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]{ return queue.empty() && !busy; });
+    }
+
+    bool
+    valid()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return good;
+    }
+};
+
 Text::Text()
-    : mystream(false), stream(NULL), descriptions(false)
+    : mystream(false), stream(NULL), asyncDepth(0), descriptions(false)
 {
 }
 
 Text::Text(std::ostream &stream)
-    : mystream(false), stream(NULL), descriptions(false)
+    : mystream(false), stream(NULL), asyncDepth(0), descriptions(false)
 {
     open(stream);
 }
 
 Text::Text(const std::string &file)
-    : mystream(false), stream(NULL), descriptions(false)
+    : mystream(false), stream(NULL), asyncDepth(0), descriptions(false)
 {
     open(file);
 }
@@ -104,6 +205,9 @@ Text::Text(const std::string &file)
 
 Text::~Text()
 {
+    // Finish writing before the stream goes away
+    writer.reset();
+
     if (mystream) {
         assert(stream);
         delete stream;
@@ -134,23 +238,87 @@ Text::open(const std::string &file)
         fatal("Unable to open statistics file for writing\n");
 }
 
+void
+Text::setAsync(unsigned depth)
+{
+    assert(stream);
+    writer.reset();
+    asyncDepth = depth;
+    if (depth)
+        writer.reset(new Writer(*stream, depth));
+}
+
+void
+Text::drain()
+{
+    if (writer)
+        writer->drain();
+}
+
+void
+Text::preFork()
+{
+    // The thread must not be running, and so holding the writer's
+    // lock, when the simulator forks.
+    writer.reset();
+}
+
+void
+Text::postFork(bool child)
+{
+    if (asyncDepth)
+        writer.reset(new Writer(*stream, asyncDepth));
+}
+
 bool
 Text::valid() const
 {
+    // The writer owns the stream while it runs
+    if (writer)
+        return writer->valid();
     return stream != NULL && stream->good();
 }
 
+template <class Print>
+void
+Text::output(const Print &print)
+{
+    if (writer)
+        pending.push_back(std::bind(print, std::placeholders::_1));
+    else
+        print(*stream);
+}
+
+namespace {
+
+struct BannerPrint
+{
+    const char *banner;
+
+    void operator()(ostream &stream) const { ccprintf(stream, banner); }
+};
+
+} // anonymous namespace
+
 void
 Text::begin()
 {
-    ccprintf(*stream, "\n---------- Begin Simulation Statistics ----------\n");
+    output(BannerPrint{
+        "\n---------- Begin Simulation Statistics ----------\n"});
 }
 
 void
 Text::end()
 {
-    ccprintf(*stream, "\n---------- End Simulation Statistics   ----------\n");
-    stream->flush();
+    output(BannerPrint{
+        "\n---------- End Simulation Statistics   ----------\n"});
+
+    if (writer) {
+        writer->push(std::move(pending));
+        pending.clear();
+    } else {
+        stream->flush();
+    }
 }
 
 bool
@@ -339,7 +507,7 @@ struct DistPrint
     bool descriptions;
     int precision;
 
-    const DistData &data;
+    DistData data;
 
     DistPrint(const Text *text, const DistInfo &info);
     DistPrint(const Text *text, const VectorDistInfo &info, int i);
@@ -429,14 +597,24 @@ DistPrint::operator()(ostream &stream) const
     if (data.type == Deviation)
         return;
 
+    for (const auto &percentile : data.percentiles) {
+        stringstream namestr;
+        namestr << base << "p" << percentile.first;
+        print.name = namestr.str();
+        print.value = percentile.second;
+        print(stream);
+    }
+
+    // Distributions and log histograms count samples out of range
+    bool bounded = data.type == Dist || data.type == LogHist;
     size_t size = data.cvec.size();
 
     Result total = 0.0;
-    if (data.type == Dist && data.underflow != NAN)
+    if (bounded && data.underflow != NAN)
         total += data.underflow;
     for (off_type i = 0; i < size; ++i)
         total += data.cvec[i];
-    if (data.type == Dist && data.overflow != NAN)
+    if (bounded && data.overflow != NAN)
         total += data.overflow;
 
     if (total) {
@@ -444,7 +622,7 @@ DistPrint::operator()(ostream &stream) const
         print.cdf = 0.0;
     }
 
-    if (data.type == Dist && data.underflow != NAN) {
+    if (bounded && data.underflow != NAN) {
         print.name = base + "underflows";
         print.update(data.underflow, total);
         print(stream);
@@ -458,8 +636,14 @@ DistPrint::operator()(ostream &stream) const
         stringstream namestr;
         namestr << base;
 
-        Counter low = i * data.bucket_size + data.min;
-        Counter high = ::min(low + data.bucket_size - 1.0, data.max);
+        Counter low, high;
+        if (data.type == LogHist) {
+            low = data.bucket_low[i];
+            high = data.bucket_high[i];
+        } else {
+            low = i * data.bucket_size + data.min;
+            high = ::min(low + data.bucket_size - 1.0, data.max);
+        }
         namestr << low;
         if (low < high)
             namestr << "-" << high;
@@ -477,7 +661,7 @@ DistPrint::operator()(ostream &stream) const
         stream << endl;
     }
 
-    if (data.type == Dist && data.overflow != NAN) {
+    if (bounded && data.overflow != NAN) {
         print.name = base + "overflows";
         print.update(data.overflow, total);
         print(stream);
@@ -486,13 +670,13 @@ DistPrint::operator()(ostream &stream) const
     print.pdf = NAN;
     print.cdf = NAN;
 
-    if (data.type == Dist && data.min_val != NAN) {
+    if (bounded && data.min_val != NAN) {
         print.name = base + "min_value";
         print.value = data.min_val;
         print(stream);
     }
 
-    if (data.type == Dist && data.max_val != NAN) {
+    if (bounded && data.max_val != NAN) {
         print.name = base + "max_value";
         print.value = data.max_val;
         print(stream);
@@ -519,7 +703,7 @@ Text::visit(const ScalarInfo &info)
     print.pdf = NAN;
     print.cdf = NAN;
 
-    print(*stream);
+    output(print);
 }
 
 void
@@ -559,7 +743,7 @@ Text::visit(const VectorInfo &info)
         }
     }
 
-    print(*stream);
+    output(print);
 }
 
 void
@@ -611,7 +795,7 @@ Text::visit(const Vector2dInfo &info)
         print.desc = info.desc;
         print.vec = yvec;
         print.total = total;
-        print(*stream);
+        output(print);
     }
 
     // Create a subname for printing the total
@@ -624,7 +808,7 @@ Text::visit(const Vector2dInfo &info)
         print.desc = info.desc;
         print.vec = VResult(1, info.total());
         print.flags = print.flags & ~total;
-        print(*stream);
+        output(print);
     }
 }
 
@@ -635,7 +819,7 @@ Text::visit(const DistInfo &info)
         return;
 
     DistPrint print(this, info);
-    print(*stream);
+    output(print);
 }
 
 void
@@ -646,7 +830,7 @@ Text::visit(const VectorDistInfo &info)
 
     for (off_type i = 0; i < info.size(); ++i) {
         DistPrint print(this, info, i);
-        print(*stream);
+        output(print);
     }
 }
 
@@ -669,7 +853,7 @@ struct SparseHistPrint
     bool descriptions;
     int precision;
 
-    const SparseHistData &data;
+    SparseHistData data;
 
     SparseHistPrint(const Text *text, const SparseHistInfo &info);
     void init(const Text *text, const Info &info);
@@ -732,11 +916,11 @@ Text::visit(const SparseHistInfo &info)
         return;
 
     SparseHistPrint print(this, info);
-    print(*stream);
+    output(print);
 }
 
 Output *
-initText(const string &filename, bool desc)
+initText(const string &filename, bool desc, unsigned queue)
 {
     static Text text;
     static bool connected = false;
@@ -744,6 +928,7 @@ initText(const string &filename, bool desc)
     if (!connected) {
         text.open(*simout.findOrCreate(filename)->stream());
         text.descriptions = desc;
+        text.setAsync(queue);
         connected = true;
     }
 
@@ -31,8 +31,11 @@
 #ifndef __BASE_STATS_TEXT_HH__
 #define __BASE_STATS_TEXT_HH__
 
+#include <functional>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/stats/output.hh"
 #include "base/stats/types.hh"
@@ -46,9 +49,21 @@ class Text : public Output
     bool mystream;
     std::ostream *stream;
 
+    class Writer;
+    /** Set when dumps are written by a background thread */
+    std::unique_ptr<Writer> writer;
+    /** Number of dumps that may wait for the writer */
+    unsigned asyncDepth;
+    /** The dump being collected for the writer */
+    std::vector<std::function<void(std::ostream &)> > pending;
+
   protected:
     bool noOutput(const Info &info);
 
+    /** Print now, or queue the print for the writer. */
+    template <class Print>
+    void output(const Print &print);
+
   public:
     bool descriptions;
 
@@ -61,6 +76,17 @@ class Text : public Output
     void open(std::ostream &stream);
     void open(const std::string &file);
 
+    /**
+     * Format and write dumps on a background thread, so that the
+     * simulation can carry on while a dump is written. Up to depth
+     * dumps may wait to be written. A depth of 0 writes dumps before
+     * end() returns.
+     */
+    void setAsync(unsigned depth);
+
+    /** Wait for the background thread to write every dump. */
+    void drain();
+
     // Implement Visit
     virtual void visit(const ScalarInfo &info);
     virtual void visit(const VectorInfo &info);
@@ -74,11 +100,16 @@ class Text : public Output
     virtual bool valid() const;
     virtual void begin();
     virtual void end();
+    /** Write every dump and stop the background thread */
+    virtual void preFork();
+    /** Start a new background thread, as the child has none */
+    virtual void postFork(bool child);
 };
 
 std::string ValueToString(Result value, int precision);
 
-Output *initText(const std::string &filename, bool desc);
+Output *initText(const std::string &filename, bool desc,
+                 unsigned queue = 0);
 
 } // namespace Stats
 
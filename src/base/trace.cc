@@ -35,13 +35,23 @@
 
 #include "base/trace.hh"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "base/debug.hh"
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/output.hh"
 #include "base/str.hh"
@@ -78,13 +88,39 @@ output()
     return getDebugLogger()->getOstream();
 }
 
+namespace
+{
+
+/** Write out a binary trace before the simulator exits */
+void
+closeBinaryLogger()
+{
+    BinaryLogger *logger = dynamic_cast<BinaryLogger *>(debug_logger);
+    if (logger)
+        logger->close();
+}
+
+} // anonymous namespace
+
 void
 setDebugLogger(Logger *logger)
 {
-    if (!logger)
+    static bool close_at_exit = false;
+
+    if (!logger) {
         warn("Trying to set debug logger to NULL\n");
-    else
-        debug_logger = logger;
+        return;
+    }
+
+    // The old logger isn't deleted since messages may still be on
+    // their way to it, but a binary one has to write out its rings.
+    closeBinaryLogger();
+    debug_logger = logger;
+
+    if (!close_at_exit && dynamic_cast<BinaryLogger *>(logger)) {
+        std::atexit(closeBinaryLogger);
+        close_at_exit = true;
+    }
 }
 
 void
@@ -157,4 +193,657 @@ OstreamLogger::logMessage(Tick when, const std::string &name,
     stream.flush();
 }
 
+namespace
+{
+
+const char binaryTraceMagic[8] = { 'G', 'E', 'M', '5', 'D', 'B', 'G', 0 };
+const uint32_t binaryTraceVersion = 1;
+
+template <typename T>
+void
+putValue(std::string &buf, T val)
+{
+    buf.append((const char *)&val, sizeof(val));
+}
+
+/** Cursor over a record that fatal()s when it runs past the end */
+class RecordReader
+{
+  protected:
+    const char *pos;
+    const char *end;
+
+  public:
+    RecordReader(const char *data, size_t len) : pos(data), end(data + len)
+    { }
+
+    template <typename T>
+    T
+    get()
+    {
+        T val;
+        fatal_if(end - pos < (ptrdiff_t)sizeof(val),
+                 "Truncated record in binary trace\n");
+        memcpy(&val, pos, sizeof(val));
+        pos += sizeof(val);
+        return val;
+    }
+
+    std::string
+    getString(size_t len)
+    {
+        fatal_if(end - pos < (ptrdiff_t)len,
+                 "Truncated record in binary trace\n");
+        std::string str(pos, len);
+        pos += len;
+        return str;
+    }
+
+    std::string rest() { return getString(end - pos); }
+};
+
+void
+printPrefix(std::ostream &out, Tick when, const std::string &name)
+{
+    if (when != MaxTick)
+        ccprintf(out, "%7d: ", when);
+
+    if (!name.empty())
+        out << name << ": ";
+}
+
+} // anonymous namespace
+
+/**
+ * The rings, definitions and background writer of a BinaryLogger,
+ * which only trace.cc needs to see.
+ */
+class BinaryLogger::Impl
+{
+  public:
+    /** Ring buffer and caches of a thread */
+    struct ThreadRing
+    {
+        const uint32_t streamId;
+        const size_t size;
+        std::unique_ptr<char[]> data;
+
+        /** Bytes logged by the thread */
+        std::atomic<uint64_t> head;
+        /** Bytes written to the trace file */
+        std::atomic<uint64_t> tail;
+
+        /** Record being built by the thread */
+        std::string record;
+
+        /** Ids of format strings by address, along with their text */
+        std::unordered_map<const char *,
+                           std::pair<uint32_t, std::string>> formats;
+        /** Ids of names by address, along with the name they were for */
+        std::unordered_map<const std::string *,
+                           std::pair<uint32_t, std::string>> names;
+
+        ThreadRing(uint32_t stream_id, size_t _size)
+            : streamId(stream_id), size(_size),
+              data(new char[_size]), head(0), tail(0)
+        { }
+    };
+
+    /** Streambuf behind getOstream() that logs text records */
+    class TextBuf : public std::streambuf
+    {
+      protected:
+        BinaryLogger &logger;
+        std::string pending;
+
+        void emit();
+        int overflow(int c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+        int sync() override;
+
+      public:
+        TextBuf(BinaryLogger &_logger) : logger(_logger) { }
+    };
+
+  protected:
+    /** Unique over all loggers, even ones allocated at the same place */
+    const uint64_t id;
+
+    std::ostream &stream;
+    /** Size of the ring buffer of each thread, a power of two */
+    const size_t ringSize;
+
+    std::mutex ringsLock;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    /** Held while writing to stream and while adding definitions */
+    std::mutex fileLock;
+    std::unordered_map<std::string, uint32_t> formats;
+    std::unordered_map<std::string, uint32_t> names;
+
+    std::mutex writerLock;
+    std::condition_variable writerWakeup;
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    uint32_t intern(std::unordered_map<std::string, uint32_t> &dict,
+                    RecordType type, const std::string &str);
+    void writeChunk(uint32_t stream_id, const char *data, size_t len,
+                    const char *more = nullptr, size_t more_len = 0);
+    void push(ThreadRing &r, const char *data, size_t len);
+    void drain();
+    void writerLoop();
+
+  public:
+    TextBuf textBuf;
+    std::ostream textStream;
+
+    Impl(BinaryLogger &logger, std::ostream &stream, size_t ring_size);
+
+    /** The ring of the calling thread */
+    ThreadRing &ring();
+    uint32_t formatId(ThreadRing &r, const char *fmt);
+    uint32_t nameId(ThreadRing &r, const std::string &name);
+    /** Log the record in the ring of the calling thread */
+    void endRecord();
+    void close();
+};
+
+namespace
+{
+
+std::atomic<uint64_t> nextLoggerId(1);
+
+/**
+ * The ring of the calling thread, and the id of the logger it belongs
+ * to. The ring is freed along with its logger, so it may only be used
+ * if the id matches.
+ */
+__thread BinaryLogger::Impl::ThreadRing *threadRing = nullptr;
+__thread uint64_t threadRingLogger = 0;
+
+} // anonymous namespace
+
+BinaryLogger::Impl::Impl(BinaryLogger &logger, std::ostream &_stream,
+                         size_t ring_size)
+    : id(nextLoggerId++), stream(_stream), ringSize(ring_size),
+      stopping(false), textBuf(logger), textStream(&textBuf)
+{
+    fatal_if(!isPowerOf2(ringSize),
+             "Binary trace ring size must be a power of 2\n");
+
+    stream.write(binaryTraceMagic, sizeof(binaryTraceMagic));
+    stream.write((const char *)&binaryTraceVersion,
+                 sizeof(binaryTraceVersion));
+
+    writer = std::thread(&Impl::writerLoop, this);
+}
+
+BinaryLogger::Impl::ThreadRing &
+BinaryLogger::Impl::ring()
+{
+    if (threadRingLogger != id) {
+        std::lock_guard<std::mutex> lock(ringsLock);
+        rings.emplace_back(new ThreadRing(rings.size() + 1, ringSize));
+        threadRing = rings.back().get();
+        threadRingLogger = id;
+    }
+    return *threadRing;
+}
+
+uint32_t
+BinaryLogger::Impl::intern(std::unordered_map<std::string, uint32_t> &dict,
+                           RecordType type, const std::string &str)
+{
+    std::lock_guard<std::mutex> lock(fileLock);
+
+    auto it = dict.find(str);
+    if (it != dict.end())
+        return it->second;
+
+    uint32_t id = dict.size() + 1;
+    dict.emplace(str, id);
+
+    std::string def;
+    putValue<uint32_t>(def, sizeof(uint8_t) + sizeof(id) + str.size());
+    putValue<uint8_t>(def, type);
+    putValue<uint32_t>(def, id);
+    def += str;
+    writeChunk(0, def.data(), def.size());
+
+    return id;
+}
+
+uint32_t
+BinaryLogger::Impl::formatId(ThreadRing &r, const char *fmt)
+{
+    // Formats are nearly always literals, but some are built in a
+    // buffer that may hold a different format the next time around.
+    auto it = r.formats.find(fmt);
+    if (it != r.formats.end() && it->second.second == fmt)
+        return it->second.first;
+
+    uint32_t id = intern(formats, FormatRecord, fmt);
+    r.formats[fmt] = std::make_pair(id, std::string(fmt));
+    return id;
+}
+
+uint32_t
+BinaryLogger::Impl::nameId(ThreadRing &r, const std::string &name)
+{
+    if (name.empty())
+        return 0;
+
+    // Names usually live in the object that logs, so their address
+    // identifies them unless the object has gone away since.
+    auto it = r.names.find(&name);
+    if (it != r.names.end() && it->second.second == name)
+        return it->second.first;
+
+    uint32_t id = intern(names, NameRecord, name);
+    r.names[&name] = std::make_pair(id, name);
+    return id;
+}
+
+void
+BinaryLogger::Impl::writeChunk(uint32_t stream_id, const char *data,
+                               size_t len, const char *more, size_t more_len)
+{
+    uint32_t chunk_len = len + more_len;
+    stream.write((const char *)&stream_id, sizeof(stream_id));
+    stream.write((const char *)&chunk_len, sizeof(chunk_len));
+    stream.write(data, len);
+    if (more_len)
+        stream.write(more, more_len);
+}
+
+void
+BinaryLogger::Impl::endRecord()
+{
+    ThreadRing &r = *threadRing;
+    uint32_t len = r.record.size() - sizeof(len);
+    memcpy(&r.record[0], &len, sizeof(len));
+    push(r, r.record.data(), r.record.size());
+}
+
+void
+BinaryLogger::Impl::push(ThreadRing &r, const char *data, size_t len)
+{
+    uint64_t head = r.head.load(std::memory_order_relaxed);
+
+    // Records may be split across chunks, so a record larger than the
+    // ring just goes out in pieces.
+    while (len) {
+        uint64_t tail = r.tail.load(std::memory_order_acquire);
+        size_t space = r.size - (head - tail);
+        if (!space) {
+            if (stopping) {
+                drain();
+            } else {
+                writerWakeup.notify_one();
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        size_t n = std::min(len, space);
+        size_t offset = head & (r.size - 1);
+        size_t first = std::min(n, r.size - offset);
+        memcpy(&r.data[offset], data, first);
+        memcpy(&r.data[0], data + first, n - first);
+
+        head += n;
+        data += n;
+        len -= n;
+        r.head.store(head, std::memory_order_release);
+    }
+
+    if (head - r.tail.load(std::memory_order_relaxed) > r.size / 2)
+        writerWakeup.notify_one();
+}
+
+void
+BinaryLogger::Impl::drain()
+{
+    std::lock_guard<std::mutex> rings_lock(ringsLock);
+
+    for (auto &r : rings) {
+        uint64_t tail = r->tail.load(std::memory_order_relaxed);
+        uint64_t head = r->head.load(std::memory_order_acquire);
+        if (head == tail)
+            continue;
+
+        size_t n = head - tail;
+        size_t offset = tail & (r->size - 1);
+        size_t first = std::min(n, r->size - offset);
+        {
+            std::lock_guard<std::mutex> file_lock(fileLock);
+            writeChunk(r->streamId, &r->data[offset], first,
+                       &r->data[0], n - first);
+        }
+        r->tail.store(head, std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> file_lock(fileLock);
+    stream.flush();
+}
+
+void
+BinaryLogger::Impl::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(writerLock);
+    while (!stopping) {
+        // Wake up now and then even when the rings are quiet so that
+        // not much of the trace is lost if the simulator crashes.
+        writerWakeup.wait_for(lock, std::chrono::milliseconds(10));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void
+BinaryLogger::Impl::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerLock);
+        if (stopping)
+            return;
+        stopping = true;
+    }
+
+    textStream.flush();
+    writerWakeup.notify_one();
+    writer.join();
+    drain();
+}
+
+void
+BinaryLogger::Impl::TextBuf::emit()
+{
+    if (pending.empty())
+        return;
+
+    logger.logMessage(MaxTick, std::string(), pending);
+    pending.clear();
+}
+
+int
+BinaryLogger::Impl::TextBuf::overflow(int c)
+{
+    if (c == traits_type::eof())
+        return traits_type::not_eof(c);
+
+    pending.push_back(c);
+    if (c == '\n')
+        emit();
+    return c;
+}
+
+std::streamsize
+BinaryLogger::Impl::TextBuf::xsputn(const char *s, std::streamsize n)
+{
+    pending.append(s, n);
+    if (memchr(s, '\n', n))
+        emit();
+    return n;
+}
+
+int
+BinaryLogger::Impl::TextBuf::sync()
+{
+    emit();
+    return 0;
+}
+
+BinaryLogger::BinaryLogger(std::ostream &stream, size_t ring_size)
+    : impl(new Impl(*this, stream, ring_size))
+{
+    binary = this;
+}
+
+BinaryLogger::~BinaryLogger()
+{
+    close();
+}
+
+std::string &
+BinaryLogger::startMessage(Tick when, const std::string &name,
+                           const char *fmt, unsigned num_args)
+{
+    Impl::ThreadRing &r = impl->ring();
+    std::string &record = r.record;
+
+    record.clear();
+    // The length is filled in by endRecord()
+    putValue<uint32_t>(record, 0);
+    putValue<uint8_t>(record, MessageRecord);
+    putValue<uint32_t>(record, impl->formatId(r, fmt));
+    putValue<uint32_t>(record, impl->nameId(r, name));
+    putValue<uint64_t>(record, when);
+    putValue<uint16_t>(record, num_args);
+
+    return record;
+}
+
+void
+BinaryLogger::endRecord()
+{
+    impl->endRecord();
+}
+
+void
+BinaryLogger::close()
+{
+    impl->close();
+}
+
+void
+BinaryLogger::logMessage(Tick when, const std::string &name,
+                         const std::string &message)
+{
+    if (!name.empty() && ignore.match(name))
+        return;
+
+    Impl::ThreadRing &r = impl->ring();
+    std::string &record = r.record;
+
+    record.clear();
+    putValue<uint32_t>(record, 0);
+    putValue<uint8_t>(record, TextRecord);
+    putValue<uint32_t>(record, impl->nameId(r, name));
+    putValue<uint64_t>(record, when);
+    record += message;
+    impl->endRecord();
+}
+
+std::ostream &
+BinaryLogger::getOstream()
+{
+    return impl->textStream;
+}
+
+namespace
+{
+
+void
+decodeMessage(std::ostream &out, const std::string &fmt, RecordReader &rec,
+              uint16_t num_args)
+{
+    cp::Print print(out, fmt);
+
+    for (uint16_t i = 0; i < num_args; i++) {
+        auto type = (BinaryArgType)rec.get<uint8_t>();
+        switch (type) {
+          case BinaryArgType::Bool:
+            print.add_arg((bool)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::Char:
+            print.add_arg((char)rec.get<int64_t>());
+            break;
+          case BinaryArgType::SignedChar:
+            print.add_arg((signed char)rec.get<int64_t>());
+            break;
+          case BinaryArgType::UnsignedChar:
+            print.add_arg((unsigned char)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::Short:
+            print.add_arg((short)rec.get<int64_t>());
+            break;
+          case BinaryArgType::UnsignedShort:
+            print.add_arg((unsigned short)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::Int:
+            print.add_arg((int)rec.get<int64_t>());
+            break;
+          case BinaryArgType::UnsignedInt:
+            print.add_arg((unsigned int)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::Long:
+            print.add_arg((long)rec.get<int64_t>());
+            break;
+          case BinaryArgType::UnsignedLong:
+            print.add_arg((unsigned long)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::LongLong:
+            print.add_arg((long long)rec.get<int64_t>());
+            break;
+          case BinaryArgType::UnsignedLongLong:
+            print.add_arg((unsigned long long)rec.get<uint64_t>());
+            break;
+          case BinaryArgType::Float:
+            print.add_arg((float)rec.get<double>());
+            break;
+          case BinaryArgType::Double:
+            print.add_arg(rec.get<double>());
+            break;
+          case BinaryArgType::String:
+            print.add_arg(rec.getString(rec.get<uint32_t>()));
+            break;
+          case BinaryArgType::Pointer:
+            print.add_arg((const void *)(uintptr_t)rec.get<uint64_t>());
+            break;
+          default:
+            fatal("Unknown argument type %d in binary trace\n", (int)type);
+        }
+    }
+
+    print.end_args();
+}
+
+/** Decoder state for the definitions in a binary trace */
+struct Definitions
+{
+    std::unordered_map<uint32_t, std::string> formats;
+    std::unordered_map<uint32_t, std::string> names;
+
+    const std::string &
+    format(uint32_t id) const
+    {
+        auto it = formats.find(id);
+        fatal_if(it == formats.end(),
+                 "Undefined format %d in binary trace\n", id);
+        return it->second;
+    }
+
+    const std::string &
+    name(uint32_t id) const
+    {
+        static const std::string no_name;
+        if (!id)
+            return no_name;
+
+        auto it = names.find(id);
+        fatal_if(it == names.end(),
+                 "Undefined name %d in binary trace\n", id);
+        return it->second;
+    }
+};
+
+void
+decodeRecord(std::ostream &out, Definitions &defs, const char *data,
+             size_t len)
+{
+    RecordReader rec(data, len);
+
+    auto type = (BinaryLogger::RecordType)rec.get<uint8_t>();
+    switch (type) {
+      case BinaryLogger::FormatRecord: {
+          uint32_t id = rec.get<uint32_t>();
+          defs.formats[id] = rec.rest();
+          break;
+      }
+      case BinaryLogger::NameRecord: {
+          uint32_t id = rec.get<uint32_t>();
+          defs.names[id] = rec.rest();
+          break;
+      }
+      case BinaryLogger::MessageRecord: {
+          const std::string &fmt =
+              defs.format(rec.get<uint32_t>());
+          const std::string &name = defs.name(rec.get<uint32_t>());
+          Tick when = rec.get<uint64_t>();
+          uint16_t num_args = rec.get<uint16_t>();
+
+          printPrefix(out, when, name);
+          decodeMessage(out, fmt, rec, num_args);
+          break;
+      }
+      case BinaryLogger::TextRecord: {
+          const std::string &name = defs.name(rec.get<uint32_t>());
+          Tick when = rec.get<uint64_t>();
+
+          printPrefix(out, when, name);
+          out << rec.rest();
+          break;
+      }
+      default:
+        fatal("Unknown record type %d in binary trace\n", (int)type);
+    }
+}
+
+} // anonymous namespace
+
+void
+decodeBinaryTrace(std::istream &in, std::ostream &out)
+{
+    char magic[sizeof(binaryTraceMagic)];
+    uint32_t version;
+    in.read(magic, sizeof(magic));
+    in.read((char *)&version, sizeof(version));
+    fatal_if(!in || memcmp(magic, binaryTraceMagic, sizeof(magic)),
+             "Not a binary trace\n");
+    fatal_if(version != binaryTraceVersion,
+             "Unsupported binary trace version %d\n", version);
+
+    Definitions defs;
+    // Bytes of each stream that don't make up a whole record yet
+    std::unordered_map<uint32_t, std::string> streams;
+
+    uint32_t header[2];
+    while (in.read((char *)header, sizeof(header))) {
+        std::string &buf = streams[header[0]];
+        size_t old_size = buf.size();
+        buf.resize(old_size + header[1]);
+        fatal_if(!in.read(&buf[old_size], header[1]),
+                 "Truncated chunk in binary trace\n");
+
+        size_t pos = 0;
+        uint32_t len;
+        while (buf.size() - pos >= sizeof(len)) {
+            memcpy(&len, &buf[pos], sizeof(len));
+            if (buf.size() - pos - sizeof(len) < len)
+                break;
+            decodeRecord(out, defs, &buf[pos + sizeof(len)], len);
+            pos += sizeof(len) + len;
+        }
+        buf.erase(0, pos);
+    }
+
+    for (const auto &stream : streams) {
+        if (!stream.second.empty())
+            warn("Binary trace ends within a record\n");
+    }
+}
+
 } // namespace Trace
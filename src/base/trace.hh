@@ -36,7 +36,11 @@
 #ifndef __BASE_TRACE_HH__
 #define __BASE_TRACE_HH__
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <type_traits>
 
 #include "base/cprintf.hh"
 #include "base/debug.hh"
@@ -46,6 +50,143 @@
 
 namespace Trace {
 
+/** Types of the DPRINTF arguments stored in a binary trace */
+enum class BinaryArgType : uint8_t
+{
+    Bool, Char, SignedChar, UnsignedChar, Short, UnsignedShort, Int,
+    UnsignedInt, Long, UnsignedLong, LongLong, UnsignedLongLong,
+    Float, Double, String, Pointer
+};
+
+/**
+ * How a DPRINTF argument is stored in a binary trace. Each argument is
+ * a BinaryArgType tag followed by its value. Only types that can be
+ * printed again exactly from their stored value have a specialization;
+ * messages with any other argument are formatted when they are logged.
+ */
+template <typename T, typename Enable = void>
+struct BinaryArg
+{
+    static const bool stored = false;
+};
+
+#define TRACE_BINARY_ARG(TYPE, TAG, STORE)                              \
+    template <>                                                         \
+    struct BinaryArg<TYPE>                                              \
+    {                                                                   \
+        static const bool stored = true;                                \
+        static void                                                     \
+        put(std::string &buf, TYPE val)                                 \
+        {                                                               \
+            STORE stored_val = val;                                     \
+            buf.push_back((char)BinaryArgType::TAG);                    \
+            buf.append((const char *)&stored_val, sizeof(stored_val));  \
+        }                                                               \
+    }
+
+TRACE_BINARY_ARG(bool, Bool, uint64_t);
+TRACE_BINARY_ARG(char, Char, int64_t);
+TRACE_BINARY_ARG(signed char, SignedChar, int64_t);
+TRACE_BINARY_ARG(unsigned char, UnsignedChar, uint64_t);
+TRACE_BINARY_ARG(short, Short, int64_t);
+TRACE_BINARY_ARG(unsigned short, UnsignedShort, uint64_t);
+TRACE_BINARY_ARG(int, Int, int64_t);
+TRACE_BINARY_ARG(unsigned int, UnsignedInt, uint64_t);
+TRACE_BINARY_ARG(long, Long, int64_t);
+TRACE_BINARY_ARG(unsigned long, UnsignedLong, uint64_t);
+TRACE_BINARY_ARG(long long, LongLong, int64_t);
+TRACE_BINARY_ARG(unsigned long long, UnsignedLongLong, uint64_t);
+TRACE_BINARY_ARG(float, Float, double);
+TRACE_BINARY_ARG(double, Double, double);
+
+#undef TRACE_BINARY_ARG
+
+inline void
+putBinaryString(std::string &buf, const char *str, size_t len)
+{
+    uint32_t stored_len = len;
+    buf.push_back((char)BinaryArgType::String);
+    buf.append((const char *)&stored_len, sizeof(stored_len));
+    buf.append(str, len);
+}
+
+template <>
+struct BinaryArg<std::string>
+{
+    static const bool stored = true;
+    static void
+    put(std::string &buf, const std::string &str)
+    {
+        putBinaryString(buf, str.data(), str.size());
+    }
+};
+
+template <typename T>
+struct BinaryArg<T *, typename std::enable_if<
+    std::is_same<typename std::remove_cv<T>::type, char>::value>::type>
+{
+    static const bool stored = true;
+    static void
+    put(std::string &buf, const char *str)
+    {
+        putBinaryString(buf, str, str ? strlen(str) : 0);
+    }
+};
+
+template <size_t N>
+struct BinaryArg<char[N]> : public BinaryArg<const char *>
+{
+};
+
+/** Pointers other than C strings are printed like a void pointer */
+template <typename T>
+struct BinaryArg<T *, typename std::enable_if<
+    (std::is_object<T>::value || std::is_void<T>::value) &&
+    !std::is_same<typename std::remove_cv<T>::type, char>::value &&
+    !std::is_same<typename std::remove_cv<T>::type, signed char>::value &&
+    !std::is_same<typename std::remove_cv<T>::type, unsigned char>::value
+    >::type>
+{
+    static const bool stored = true;
+    static void
+    put(std::string &buf, const T *ptr)
+    {
+        uint64_t stored_val = (uintptr_t)ptr;
+        buf.push_back((char)BinaryArgType::Pointer);
+        buf.append((const char *)&stored_val, sizeof(stored_val));
+    }
+};
+
+template <typename ...Args>
+struct BinaryArgs;
+
+template <>
+struct BinaryArgs<>
+{
+    static const bool stored = true;
+    static void put(std::string &buf) { }
+};
+
+template <typename T, typename ...Args>
+struct BinaryArgs<T, Args...>
+{
+    static const bool stored =
+        BinaryArg<T>::stored && BinaryArgs<Args...>::stored;
+
+    static void
+    put(std::string &buf, const T &val, const Args &...args)
+    {
+        BinaryArg<T>::put(buf, val);
+        BinaryArgs<Args...>::put(buf, args...);
+    }
+};
+
+class BinaryLogger;
+
+template <typename ...Args>
+void binaryDprintf(BinaryLogger *logger, Tick when, const std::string &name,
+                   const char *fmt, const Args &...args);
+
 /** Debug logging base class.  Handles formatting and outputting
  *  time/name/message messages */
 class Logger
@@ -54,7 +195,29 @@ class Logger
     /** Name match for objects to ignore */
     ObjectMatch ignore;
 
+    /** Set by a logger that stores messages without formatting them */
+    BinaryLogger *binary;
+
+    template <typename ...Args>
+    bool
+    dprintfBinary(std::true_type, Tick when, const std::string &name,
+                  const char *fmt, const Args &...args)
+    {
+        binaryDprintf(binary, when, name, fmt, args...);
+        return true;
+    }
+
+    template <typename ...Args>
+    bool
+    dprintfBinary(std::false_type, Tick when, const std::string &name,
+                  const char *fmt, const Args &...args)
+    {
+        return false;
+    }
+
   public:
+    Logger() : binary(nullptr) { }
+
     /** Log a single message */
     template <typename ...Args>
     void dprintf(Tick when, const std::string &name, const char *fmt,
@@ -63,6 +226,11 @@ class Logger
         if (!name.empty() && ignore.match(name))
             return;
 
+        typedef std::integral_constant<bool, BinaryArgs<Args...>::stored>
+            Stored;
+        if (binary && dprintfBinary(Stored(), when, name, fmt, args...))
+            return;
+
         std::ostringstream line;
         ccprintf(line, fmt, args...);
         logMessage(when, name, line.str());
@@ -109,6 +277,79 @@ class OstreamLogger : public Logger
     std::ostream &getOstream() override { return stream; }
 };
 
+/**
+ * Logger that writes a binary trace. DPRINTF messages are stored as
+ * ids for their format string and name, the tick and their raw
+ * arguments, and are only formatted when the trace is decoded with
+ * decodeBinaryTrace(). Each thread stores its messages in a ring
+ * buffer of its own without taking any locks, and a background thread
+ * writes the rings to the trace file.
+ *
+ * The file is a header followed by chunks of the byte streams of the
+ * threads, each chunk a 32-bit stream number and a 32-bit length.
+ * Stream 0 holds the format string and name definitions, which are
+ * always written before the first chunk that uses them.
+ */
+class BinaryLogger : public Logger
+{
+  public:
+    /** Record types in the streams of a binary trace */
+    enum RecordType : uint8_t
+    {
+        FormatRecord = 'F',
+        NameRecord = 'N',
+        MessageRecord = 'M',
+        TextRecord = 'T',
+    };
+
+    /** The rings and the background writer, defined in trace.cc */
+    class Impl;
+
+  protected:
+    std::unique_ptr<Impl> impl;
+
+  public:
+    BinaryLogger(std::ostream &stream, size_t ring_size = 1 << 20);
+    ~BinaryLogger();
+
+    /**
+     * Start a message record in the buffer of the calling thread. The
+     * arguments are then appended to the returned buffer, and the
+     * record is logged with endRecord().
+     */
+    std::string &startMessage(Tick when, const std::string &name,
+                              const char *fmt, unsigned num_args);
+
+    /** Log the record started last by the calling thread */
+    void endRecord();
+
+    /** Stop the background writer and write out everything logged */
+    void close();
+
+    void logMessage(Tick when, const std::string &name,
+                    const std::string &message) override;
+
+    std::ostream &getOstream() override;
+};
+
+template <typename ...Args>
+void
+binaryDprintf(BinaryLogger *logger, Tick when, const std::string &name,
+              const char *fmt, const Args &...args)
+{
+    std::string &record =
+        logger->startMessage(when, name, fmt, sizeof...(Args));
+    BinaryArgs<Args...>::put(record, args...);
+    logger->endRecord();
+}
+
+/**
+ * Decode a binary trace written by a BinaryLogger to the text an
+ * OstreamLogger would have written. Messages logged by different
+ * threads appear in the order their chunks were written out.
+ */
+void decodeBinaryTrace(std::istream &in, std::ostream &out);
+
 /** Get the current global debug logger.  This takes ownership of the given
  *  logger which should be allocated using 'new' */
 Logger *getDebugLogger();
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "base/trace.hh"
+
+namespace
+{
+
+struct Printable
+{
+    int val;
+};
+
+std::ostream &
+operator<<(std::ostream &os, const Printable &p)
+{
+    return os << "Printable(" << p.val << ")";
+}
+
+int target;
+
+template <class Logger>
+void
+logMessages(Logger &logger)
+{
+    const std::string name("system.cpu");
+    const char *cstr = "cstr";
+    std::string str("str");
+
+    for (int i = 0; i < 100; i++) {
+        logger.dprintf(i * 500, name, "%d %#x %u %s %s\n", -i, i,
+                       (unsigned)i, cstr, str);
+        logger.dprintf(i, name, "%f %.3f %g %c %p\n", 1.5f * i, 3.14159 * i,
+                       2.0 / 3, 'a', &target);
+        logger.dprintf(MaxTick, std::string(), "%d %x %d %s\n", (int64_t)-1,
+                       (uint64_t)-1, (uint8_t)200, "literal");
+        logger.dprintf(i, "other" + std::to_string(i % 3), "%s %d\n",
+                       Printable{i}, true);
+        logger.dprintf(i, name, "no arguments\n");
+        logger.dump(i, name, "abcdefghijklmnopqrstuvwxyz", 26);
+        logger.getOstream() << "ostream " << i << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+TEST(TraceTest, BinaryDecodesToText)
+{
+    std::ostringstream text;
+    Trace::OstreamLogger text_logger(text);
+    logMessages(text_logger);
+
+    std::ostringstream binary;
+    {
+        // A small ring so that records wrap and get split
+        Trace::BinaryLogger binary_logger(binary, 1 << 10);
+        logMessages(binary_logger);
+    }
+
+    std::istringstream in(binary.str());
+    std::ostringstream decoded;
+    Trace::decodeBinaryTrace(in, decoded);
+
+    EXPECT_EQ(text.str(), decoded.str());
+}
+
+TEST(TraceTest, BinaryDynamicFormats)
+{
+    std::ostringstream binary;
+    {
+        Trace::BinaryLogger binary_logger(binary, 1 << 10);
+        // Both formats come from the same buffer
+        char fmt[16];
+        strcpy(fmt, "first %d\n");
+        binary_logger.dprintf(1, "a", fmt, 1);
+        strcpy(fmt, "second %d\n");
+        binary_logger.dprintf(2, "a", fmt, 2);
+    }
+
+    std::istringstream in(binary.str());
+    std::ostringstream decoded;
+    Trace::decodeBinaryTrace(in, decoded);
+
+    std::ostringstream text;
+    Trace::OstreamLogger text_logger(text);
+    text_logger.dprintf(1, "a", "first %d\n", 1);
+    text_logger.dprintf(2, "a", "second %d\n", 2);
+
+    EXPECT_EQ(text.str(), decoded.str());
+}
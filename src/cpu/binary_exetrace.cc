@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/binary_exetrace.hh"
+
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "arch/utility.hh"
+#include "base/callback.hh"
+#include "base/loader/symtab.hh"
+#include "base/output.hh"
+#include "config/the_isa.hh"
+#include "cpu/base.hh"
+#include "cpu/static_inst.hh"
+#include "cpu/thread_context.hh"
+#include "debug/ExecAll.hh"
+#include "enums/OpClass.hh"
+#include "proto/exec_trace.pb.h"
+#include "proto/protoio.hh"
+#include "sim/core.hh"
+#include "sim/full_system.hh"
+
+namespace Trace {
+
+typedef ProtoMessage::ExecTraceBlock ExecTraceBlock;
+
+class BinaryExeTracer::TraceFile
+{
+  public:
+    struct Context
+    {
+        uint32_t id;
+        /** Block that lastPc and lastAddr are from */
+        uint64_t block;
+        Addr lastPc;
+        Addr lastAddr;
+    };
+
+  protected:
+    struct InstKey
+    {
+        const StaticInst *inst;
+        Addr pc;
+        bool symbolic;
+
+        bool
+        operator==(const InstKey &other) const
+        {
+            return inst == other.inst && pc == other.pc &&
+                symbolic == other.symbolic;
+        }
+    };
+
+    struct InstKeyHash
+    {
+        size_t
+        operator()(const InstKey &key) const
+        {
+            return std::hash<Addr>()(key.pc ^ ((uintptr_t)key.inst << 1) ^
+                                     key.symbolic);
+        }
+    };
+
+    ProtoOutputStream stream;
+    const unsigned blockSize;
+
+    ExecTraceBlock block;
+    std::string records;
+    unsigned numRecords;
+    uint64_t blockNum;
+    uint32_t format;
+    Tick lastTick;
+
+    std::unordered_map<const ThreadContext *, Context> contexts;
+    std::unordered_map<InstKey, uint32_t, InstKeyHash> insts;
+    /** Keeps the static instructions alive so that their addresses
+     * aren't reused for others */
+    std::vector<StaticInstPtr> instRefs;
+
+  public:
+    TraceFile(const std::string &filename, unsigned block_size)
+        : stream(filename), blockSize(block_size), numRecords(0),
+          blockNum(0), format(0), lastTick(0)
+    {
+        ProtoMessage::ExecTraceHeader header;
+        header.set_obj_id("gem5 generated exec trace");
+        header.set_ver(0);
+        header.set_tick_freq(SimClock::Frequency);
+        stream.write(header);
+    }
+
+    ~TraceFile() { flush(); }
+
+    uint32_t blockFormat() const { return format; }
+
+    void
+    putVarint(uint64_t val)
+    {
+        while (val >= 0x80) {
+            records.push_back((char)(val | 0x80));
+            val >>= 7;
+        }
+        records.push_back((char)val);
+    }
+
+    void
+    putSigned(int64_t val)
+    {
+        putVarint(((uint64_t)val << 1) ^ (uint64_t)(val >> 63));
+    }
+
+    /** Start a record in a block with the given format */
+    void
+    startRecord(uint32_t record_format, Tick when)
+    {
+        if (record_format != format) {
+            flush();
+            format = record_format;
+        }
+        putSigned(when - lastTick);
+        lastTick = when;
+    }
+
+    void
+    endRecord()
+    {
+        if (++numRecords == blockSize)
+            flush();
+    }
+
+    Context &
+    context(ThreadContext *tc)
+    {
+        auto it = contexts.find(tc);
+        if (it == contexts.end()) {
+            Context ctx = { (uint32_t)contexts.size(), blockNum, 0, 0 };
+            it = contexts.emplace(tc, ctx).first;
+
+            auto *def = block.add_contexts();
+            def->set_id(ctx.id);
+            def->set_name(tc->getCpuPtr()->name());
+            def->set_thread_id(tc->threadId());
+        }
+
+        Context &ctx = it->second;
+        if (ctx.block != blockNum) {
+            ctx.block = blockNum;
+            ctx.lastPc = 0;
+            ctx.lastAddr = 0;
+        }
+        return ctx;
+    }
+
+    uint32_t
+    instId(const StaticInstPtr &inst, Addr pc, bool symbolic)
+    {
+        InstKey key = { inst.get(), pc, symbolic };
+        auto it = insts.find(key);
+        if (it != insts.end())
+            return it->second;
+
+        uint32_t id = insts.size();
+        insts.emplace(key, id);
+        instRefs.push_back(inst);
+
+        auto *def = block.add_insts();
+        def->set_id(id);
+
+        std::string sym_str;
+        Addr sym_addr;
+        if (symbolic &&
+                debugSymbolTable->findNearestSymbol(pc, sym_str, sym_addr)) {
+            if (pc != sym_addr)
+                sym_str += csprintf("+%d", pc - sym_addr);
+            def->set_symbol(sym_str);
+        }
+
+        def->set_disassembly(inst->disassemble(pc, debugSymbolTable));
+        def->set_op_class(Enums::OpClassStrings[inst->opClass()]);
+
+        std::ostringstream flags;
+        inst->printFlags(flags, "|");
+        def->set_flags(flags.str());
+
+        return id;
+    }
+
+    void
+    flush()
+    {
+        if (!numRecords)
+            return;
+
+        block.set_format(format);
+        block.set_num_records(numRecords);
+        block.set_records(records);
+        stream.write(block);
+
+        block.Clear();
+        records.clear();
+        numRecords = 0;
+        blockNum++;
+        lastTick = 0;
+    }
+};
+
+BinaryExeTracer::TraceFile *BinaryExeTracer::traceFile = nullptr;
+
+BinaryExeTracer::BinaryExeTracer(const Params *p)
+    : ExeTracer(p)
+{
+    // Since there is only one output file for all tracers check if it
+    // exists
+    if (traceFile)
+        return;
+
+    traceFile = new TraceFile(simout.resolve(p->file_name), p->block_size);
+
+    registerExitCallback(new MakeCallback<BinaryExeTracer,
+                         &BinaryExeTracer::closeTraceFile>(this));
+}
+
+void
+BinaryExeTracer::closeTraceFile()
+{
+    delete traceFile;
+    traceFile = nullptr;
+}
+
+uint32_t
+BinaryExeTracer::currentFormat()
+{
+    uint32_t format = 0;
+    if (Debug::ExecTicks)
+        format |= ExecTraceBlock::Ticks;
+    if (Debug::ExecAsid)
+        format |= ExecTraceBlock::Asid;
+    if (Debug::ExecThread)
+        format |= ExecTraceBlock::Thread;
+    if (Debug::ExecOpClass)
+        format |= ExecTraceBlock::OpClass;
+    if (Debug::ExecResult)
+        format |= ExecTraceBlock::Result;
+    if (Debug::ExecEffAddr)
+        format |= ExecTraceBlock::EffAddr;
+    if (Debug::ExecFetchSeq)
+        format |= ExecTraceBlock::FetchSeq;
+    if (Debug::ExecCPSeq)
+        format |= ExecTraceBlock::CPSeq;
+    if (Debug::ExecFlags)
+        format |= ExecTraceBlock::Flags;
+    return format;
+}
+
+InstRecord *
+BinaryExeTracer::getInstRecord(Tick when, ThreadContext *tc,
+        const StaticInstPtr staticInst, TheISA::PCState pc,
+        const StaticInstPtr macroStaticInst)
+{
+    if (!Debug::ExecEnable || !traceFile)
+        return NULL;
+
+    return new BinaryExeTracerRecord(*this, when, tc, staticInst, pc,
+                                     macroStaticInst);
+}
+
+void
+BinaryExeTracerRecord::traceInst(const StaticInstPtr &inst, bool ran)
+{
+    if (!Debug::ExecUser || !Debug::ExecKernel) {
+        bool in_user_mode = TheISA::inUserMode(thread);
+        if (in_user_mode && !Debug::ExecUser) return;
+        if (!in_user_mode && !Debug::ExecKernel) return;
+    }
+
+    BinaryExeTracer::TraceFile &file = *BinaryExeTracer::traceFile;
+
+    uint64_t record_flags = 0;
+    if (ran)
+        record_flags |= BinaryExeTracer::Ran;
+    if (inst->isMicroop())
+        record_flags |= BinaryExeTracer::Microop;
+    if (!predicate)
+        record_flags |= BinaryExeTracer::PredicateFalse;
+    if (ran && getMemValid())
+        record_flags |= BinaryExeTracer::MemValid;
+    if (ran && fetch_seq_valid)
+        record_flags |= BinaryExeTracer::FetchSeqValid;
+    if (ran && cp_seq_valid)
+        record_flags |= BinaryExeTracer::CPSeqValid;
+
+    Addr cur_pc = pc.instAddr();
+    bool symbolic = debugSymbolTable && Debug::ExecSymbol &&
+        (!FullSystem || !TheISA::inUserMode(thread));
+
+    file.startRecord(BinaryExeTracer::currentFormat(), when);
+    file.putVarint(record_flags);
+
+    BinaryExeTracer::TraceFile::Context &ctx = file.context(thread);
+    file.putVarint(ctx.id);
+    file.putVarint(file.instId(inst, cur_pc, symbolic));
+    file.putSigned(cur_pc - ctx.lastPc);
+    ctx.lastPc = cur_pc;
+
+    if (inst->isMicroop())
+        file.putVarint(pc.microPC());
+
+    if (file.blockFormat() & ExecTraceBlock::Asid)
+        file.putVarint(TheISA::getExecutingAsid(thread));
+
+    if (ran) {
+        file.putVarint(data_status);
+        switch (data_status) {
+          case DataInvalid:
+            break;
+          case DataVec:
+            {
+                auto dv = data.as_vec->as<uint32_t>();
+                const int words = TheISA::VecRegSizeBytes / 4;
+                file.putVarint(words);
+                for (int i = 0; i < words; i++)
+                    file.putVarint(dv[i]);
+            }
+            break;
+          case DataVecPred:
+            {
+                auto pv = data.as_pred->as<uint8_t>();
+                const int bits = TheISA::VecPredRegSizeBits;
+                file.putVarint(bits);
+                for (int i = 0; i < bits; i += 8) {
+                    uint8_t byte = 0;
+                    for (int j = 0; j < 8 && i + j < bits; j++)
+                        byte |= (pv[i + j] ? 1 : 0) << j;
+                    file.putVarint(byte);
+                }
+            }
+            break;
+          default:
+            file.putVarint(data.as_int);
+            break;
+        }
+
+        if (getMemValid()) {
+            file.putSigned(addr - ctx.lastAddr);
+            ctx.lastAddr = addr;
+        }
+
+        if (fetch_seq_valid)
+            file.putVarint(fetch_seq);
+
+        if (cp_seq_valid)
+            file.putVarint(cp_seq);
+    }
+
+    file.endRecord();
+}
+
+} // namespace Trace
+
+Trace::BinaryExeTracer *
+BinaryExeTracerParams::create()
+{
+    return new Trace::BinaryExeTracer(this);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_BINARY_EXETRACE_HH__
+#define __CPU_BINARY_EXETRACE_HH__
+
+#include "cpu/exetrace.hh"
+#include "params/BinaryExeTracer.hh"
+
+namespace Trace {
+
+class BinaryExeTracer;
+
+/**
+ * Record of an instruction traced by a BinaryExeTracer. It picks the
+ * same macro and microops to trace as an ExeTracerRecord, but encodes
+ * them rather than printing them.
+ */
+class BinaryExeTracerRecord : public ExeTracerRecord
+{
+  protected:
+    BinaryExeTracer &tracer;
+
+  public:
+    BinaryExeTracerRecord(BinaryExeTracer &_tracer, Tick _when,
+                          ThreadContext *_thread,
+                          const StaticInstPtr _staticInst,
+                          TheISA::PCState _pc,
+                          const StaticInstPtr _macroStaticInst = NULL)
+        : ExeTracerRecord(_when, _thread, _staticInst, _pc,
+                          _macroStaticInst),
+          tracer(_tracer)
+    {
+    }
+
+    void traceInst(const StaticInstPtr &inst, bool ran) override;
+};
+
+/**
+ * An ExeTracer that writes a compact binary trace instead of text. The
+ * trace is a protobuf stream, see proto/exec_trace.proto, which is
+ * compressed if the file name ends in .gz. Instructions are packed
+ * into blocks of records, and the text of each static instruction is
+ * only stored the first time it is traced at a PC.
+ * util/decode_exec_trace.py decodes a trace to the text ExeTracer
+ * would have printed with the same Exec debug flags.
+ *
+ * Each record is a sequence of varints, signed values being zigzag
+ * encoded:
+ *
+ * - tick, as the difference from the previous record in the block
+ * - flags, a combination of RecordFlags
+ * - context id
+ * - static instruction id
+ * - PC, as the difference from the previous PC of the context
+ * - micro PC, for microops
+ * - ASID, if the format of the block includes it
+ * - data status and data, for instructions that ran. Vector results
+ *   are a count of 32-bit words followed by the words, and predicate
+ *   results a count of bits followed by the bits, eight to a varint.
+ * - memory address, for instructions that ran and accessed memory, as
+ *   the difference from the previous address of the context
+ * - fetch and commit sequence numbers, when they are valid
+ *
+ * The differences are taken from zero at the start of every block.
+ */
+class BinaryExeTracer : public ExeTracer
+{
+  public:
+    typedef BinaryExeTracerParams Params;
+
+    enum RecordFlags
+    {
+        Ran = 1,
+        Microop = 2,
+        PredicateFalse = 4,
+        MemValid = 8,
+        FetchSeqValid = 16,
+        CPSeqValid = 32,
+    };
+
+    BinaryExeTracer(const Params *p);
+
+    InstRecord *
+    getInstRecord(Tick when, ThreadContext *tc,
+            const StaticInstPtr staticInst, TheISA::PCState pc,
+            const StaticInstPtr macroStaticInst = NULL) override;
+
+  protected:
+    /** The trace file and encoder state, shared by all the tracers */
+    class TraceFile;
+    static TraceFile *traceFile;
+
+    /** The Exec debug flags that the output format depends on */
+    static uint32_t currentFormat();
+
+    /** Write the last block and close the file */
+    void closeTraceFile();
+
+    friend class BinaryExeTracerRecord;
+};
+
+} // namespace Trace
+
+#endif // __CPU_BINARY_EXETRACE_HH__
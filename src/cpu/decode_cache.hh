@@ -32,6 +32,7 @@
 #define __CPU_DECODE_CACHE_HH__
 
 #include <unordered_map>
+#include <vector>
 
 #include "arch/isa_traits.hh"
 #include "arch/types.hh"
@@ -104,7 +105,7 @@ class AddrMap
         }
 
         // Didn't find an existing page, so add a new one.
-        CachePage *newPage = new CachePage;
+        CachePage *newPage = new CachePage();
         page_addr = page_addr & ~(TheISA::PageBytes - 1);
         typename PageMap::value_type to_insert(page_addr, newPage);
         update(pageMap.insert(to_insert).first);
@@ -126,6 +127,78 @@ class AddrMap
     }
 };
 
+/// A small direct-mapped cache from an address and a decoder context to
+/// a Value. Decoders probe it before the AddrMap and InstMap lookups,
+/// which both go through a hash map. A hit only says that Value was the
+/// last thing decoded at this address in this context; callers must
+/// still check that it matches the bytes being decoded.
+/// @tparam IndexBits log2 of the number of entries.
+/// @tparam IndexShift log2 of the minimum instruction alignment.
+template<class Value, unsigned IndexBits = 12, unsigned IndexShift = 0>
+class DirectMap
+{
+  public:
+    /// Decoder state the decoding depends on, e.g. the x86 mode.
+    typedef uint64_t Context;
+
+  protected:
+    struct Entry
+    {
+        Addr addr;
+        Context context;
+        bool valid;
+        Value value;
+
+        Entry() : addr(0), context(0), valid(false), value() {}
+    };
+
+    static const size_t NumEntries = size_t(1) << IndexBits;
+    std::vector<Entry> entries;
+
+    Entry &
+    entry(Addr addr)
+    {
+        return entries[(addr >> IndexShift) & (NumEntries - 1)];
+    }
+
+  public:
+    /// Constructor
+    DirectMap() : entries(NumEntries)
+    {}
+
+    /// Look up the value cached for an address.
+    /// @param addr The address to look up.
+    /// @param context The decoder context the value was cached under.
+    /// @retval A pointer to the cached value, or nullptr on a miss.
+    Value *
+    lookup(Addr addr, Context context = 0)
+    {
+        Entry &e = entry(addr);
+        if (e.valid && e.addr == addr && e.context == context)
+            return &e.value;
+        return nullptr;
+    }
+
+    /// Cache a value, evicting whatever else mapped to the same entry.
+    void
+    insert(Addr addr, Context context, const Value &value)
+    {
+        Entry &e = entry(addr);
+        e.addr = addr;
+        e.context = context;
+        e.valid = true;
+        e.value = value;
+    }
+
+    /// Drop all cached values.
+    void
+    clear()
+    {
+        for (auto &e : entries)
+            e = Entry();
+    }
+};
+
 } // namespace DecodeCache
 
 #endif // __CPU_DECODE_CACHE_HH__
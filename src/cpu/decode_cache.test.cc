@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <tuple>
+
+#include "cpu/decode_cache.hh"
+
+using namespace DecodeCache;
+
+typedef DirectMap<int, 4, 2> SmallMap;
+
+/** Nothing hits in a new map. */
+TEST(DecodeCacheDirectMapTest, Empty)
+{
+    SmallMap map;
+
+    for (Addr addr = 0; addr < 0x100; addr += 4)
+        ASSERT_EQ(map.lookup(addr), nullptr);
+}
+
+/** A value can be found again under its address and context only. */
+TEST(DecodeCacheDirectMapTest, InsertLookup)
+{
+    SmallMap map;
+
+    map.insert(0x40, 1, 10);
+
+    int *value = map.lookup(0x40, 1);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, 10);
+
+    EXPECT_EQ(map.lookup(0x40, 0), nullptr);
+    EXPECT_EQ(map.lookup(0x44, 1), nullptr);
+
+    map.insert(0x40, 1, 11);
+    value = map.lookup(0x40, 1);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, 11);
+}
+
+/**
+ * Addresses that differ only below IndexShift or above
+ * IndexBits + IndexShift share an entry, and evict each other.
+ */
+TEST(DecodeCacheDirectMapTest, Aliasing)
+{
+    SmallMap map;
+
+    map.insert(0x40, 0, 1);
+    map.insert(0x41, 0, 2);
+    EXPECT_EQ(map.lookup(0x40), nullptr);
+    ASSERT_NE(map.lookup(0x41), nullptr);
+    EXPECT_EQ(*map.lookup(0x41), 2);
+
+    // 16 entries of 4 bytes wrap around every 64 bytes.
+    map.insert(0x80, 0, 3);
+    EXPECT_EQ(map.lookup(0x41), nullptr);
+    ASSERT_NE(map.lookup(0x80), nullptr);
+    EXPECT_EQ(*map.lookup(0x80), 3);
+
+    // Neighbouring entries are left alone.
+    map.insert(0x84, 0, 4);
+    ASSERT_NE(map.lookup(0x80), nullptr);
+    EXPECT_EQ(*map.lookup(0x80), 3);
+    ASSERT_NE(map.lookup(0x84), nullptr);
+    EXPECT_EQ(*map.lookup(0x84), 4);
+}
+
+/** A different context evicts the entry too. */
+TEST(DecodeCacheDirectMapTest, ContextEvicts)
+{
+    SmallMap map;
+
+    map.insert(0x40, 0, 1);
+    map.insert(0x40, 1, 2);
+    EXPECT_EQ(map.lookup(0x40, 0), nullptr);
+    ASSERT_NE(map.lookup(0x40, 1), nullptr);
+    EXPECT_EQ(*map.lookup(0x40, 1), 2);
+}
+
+/** Clearing drops every entry. */
+TEST(DecodeCacheDirectMapTest, Clear)
+{
+    SmallMap map;
+
+    for (Addr addr = 0; addr < 0x40; addr += 4)
+        map.insert(addr, 0, addr);
+    map.clear();
+    for (Addr addr = 0; addr < 0x40; addr += 4)
+        EXPECT_EQ(map.lookup(addr), nullptr);
+}
+
+/**
+ * A random stream of inserts and lookups gives the same results as a
+ * reference model which keeps the last insert into every entry.
+ */
+TEST(DecodeCacheDirectMapTest, RandomAgainstModel)
+{
+    SmallMap map;
+    std::map<Addr, std::tuple<Addr, SmallMap::Context, int>> model;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<Addr> addrs(0, 0x400);
+    std::uniform_int_distribution<SmallMap::Context> contexts(0, 2);
+
+    for (int i = 0; i < 100000; i++) {
+        Addr addr = addrs(rng);
+        SmallMap::Context context = contexts(rng);
+        Addr index = (addr >> 2) & 0xf;
+
+        if (rng() % 3 == 0) {
+            map.insert(addr, context, i);
+            model[index] = std::make_tuple(addr, context, i);
+            continue;
+        }
+
+        int *value = map.lookup(addr, context);
+        auto it = model.find(index);
+        if (it != model.end() && std::get<0>(it->second) == addr &&
+                std::get<1>(it->second) == context) {
+            ASSERT_NE(value, nullptr);
+            ASSERT_EQ(*value, std::get<2>(it->second));
+        } else {
+            ASSERT_EQ(value, nullptr);
+        }
+    }
+}
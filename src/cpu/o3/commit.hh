@@ -211,6 +211,12 @@ class DefaultCommit
     /** Ticks the commit stage, which tries to commit instructions. */
     void tick();
 
+    /**
+     * Credit the stats that tick() would have recorded over cycles
+     * during which the CPU was asleep and the stage was not ticked.
+     */
+    void creditIdleCycles(Cycles cycles);
+
     /** Handles any squashes that are sent from IEW, and adds instructions
      * to the ROB and tries to commit instructions.
      */
@@ -810,6 +810,30 @@ DefaultCommit<Impl>::propagateInterrupt()
         toIEW->commitInfo[0].interruptPending = true;
 }
 
+template <class Impl>
+void
+DefaultCommit<Impl>::creditIdleCycles(Cycles cycles)
+{
+    if (activeThreads->empty())
+        return;
+
+    // commitInsts() would have found no instruction ready at the head
+    // of the ROB. Only the single-threaded head check is mirrored; the
+    // SMT commit policies probe the ROB a policy-dependent number of
+    // times.
+    if (numThreads == 1) {
+        ThreadID tid = activeThreads->front();
+
+        if (commitStatus[tid] == Running ||
+            commitStatus[tid] == Idle ||
+            commitStatus[tid] == FetchTrapPending) {
+            rob->creditHeadReads(cycles);
+        }
+    }
+
+    numCommittedDist.sample(0, cycles);
+}
+
 template <class Impl>
 void
 DefaultCommit<Impl>::commit()
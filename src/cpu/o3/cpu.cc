@@ -1760,6 +1760,14 @@ FullO3CPU<Impl>::wakeCPU()
         --cycles;
         idleCycles += cycles;
         numCycles += cycles;
+
+        // Credit the stages with what they would have recorded had
+        // they been ticked through the idle period.
+        fetch.creditIdleCycles(cycles);
+        decode.creditIdleCycles(cycles);
+        rename.creditIdleCycles(cycles);
+        iew.creditIdleCycles(cycles);
+        commit.creditIdleCycles(cycles);
     }
 
     schedule(tickEvent, clockEdge());
@@ -140,6 +140,12 @@ class DefaultDecode
      */
     void tick();
 
+    /**
+     * Credit the stats that tick() would have recorded over cycles
+     * during which the CPU was asleep and the stage was not ticked.
+     */
+    void creditIdleCycles(Cycles cycles);
+
     /** Determines what to do based on decode's current status.
      * @param status_change decode() sets this variable if there was a status
      * change (ie switching from from blocking to unblocking).
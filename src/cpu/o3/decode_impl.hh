@@ -597,6 +597,23 @@ DefaultDecode<Impl>::tick()
     }
 }
 
+template<class Impl>
+void
+DefaultDecode<Impl>::creditIdleCycles(Cycles cycles)
+{
+    // Mirror decode() for a stage with nothing to decode.
+    for (ThreadID tid : *activeThreads) {
+        if (decodeStatus[tid] == Blocked) {
+            decodeBlockedCycles += cycles;
+        } else if (decodeStatus[tid] == Squashing) {
+            decodeSquashCycles += cycles;
+        } else if (decodeStatus[tid] == Running ||
+                   decodeStatus[tid] == Idle) {
+            decodeIdleCycles += cycles;
+        }
+    }
+}
+
 template<class Impl>
 void
 DefaultDecode<Impl>::decode(bool &status_change, ThreadID tid)
@@ -332,6 +332,12 @@ class DefaultFetch
      */
     void tick();
 
+    /**
+     * Credit the stats that tick() would have recorded over cycles
+     * during which the CPU was asleep and the stage was not ticked.
+     */
+    void creditIdleCycles(Cycles cycles);
+
     /** Checks all input signals and updates the status as necessary.
      *  @return: Returns if the status has changed due to input signals.
      */
@@ -377,8 +383,8 @@ class DefaultFetch
     /** Pipeline the next I-cache access to the current one. */
     void pipelineIcacheAccesses(ThreadID tid);
 
-    /** Profile the reasons of fetch stall. */
-    void profileStall(ThreadID tid);
+    /** Profile the reasons of fetch stall, attributing count cycles. */
+    void profileStall(ThreadID tid, Counter count = 1);
 
   private:
     /** Pointer to the O3CPU. */
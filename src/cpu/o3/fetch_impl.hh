@@ -991,6 +991,25 @@ DefaultFetch<Impl>::tick()
     numInst = 0;
 }
 
+template <class Impl>
+void
+DefaultFetch<Impl>::creditIdleCycles(Cycles cycles)
+{
+    // Nothing was fetched while the CPU was asleep. Attribute the cycles
+    // the same way fetch() does when it finds nothing to do.
+    fetchNisnDist.sample(0, cycles);
+
+    if (numThreads == 1) {  // @todo Per-thread stats
+        ThreadID tid = activeThreads->empty() ? 0 : activeThreads->front();
+
+        if (!activeThreads->empty() && fetchStatus[tid] == Idle) {
+            fetchIdleCycles += cycles;
+        } else {
+            profileStall(tid, cycles);
+        }
+    }
+}
+
 template <class Impl>
 bool
 DefaultFetch<Impl>::checkSignalsAndUpdate(ThreadID tid)
@@ -1623,41 +1642,41 @@ DefaultFetch<Impl>::pipelineIcacheAccesses(ThreadID tid)
 
 template<class Impl>
 void
-DefaultFetch<Impl>::profileStall(ThreadID tid) {
+DefaultFetch<Impl>::profileStall(ThreadID tid, Counter count) {
     DPRINTF(Fetch,"There are no more threads available to fetch from.\n");
 
     // @todo Per-thread stats
 
     if (stalls[tid].drain) {
-        ++fetchPendingDrainCycles;
+        fetchPendingDrainCycles += count;
         DPRINTF(Fetch, "Fetch is waiting for a drain!\n");
     } else if (activeThreads->empty()) {
-        ++fetchNoActiveThreadStallCycles;
+        fetchNoActiveThreadStallCycles += count;
         DPRINTF(Fetch, "Fetch has no active thread!\n");
     } else if (fetchStatus[tid] == Blocked) {
-        ++fetchBlockedCycles;
+        fetchBlockedCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is blocked!\n", tid);
     } else if (fetchStatus[tid] == Squashing) {
-        ++fetchSquashCycles;
+        fetchSquashCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is squashing!\n", tid);
     } else if (fetchStatus[tid] == IcacheWaitResponse) {
-        ++icacheStallCycles;
+        icacheStallCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is waiting cache response!\n",
                 tid);
     } else if (fetchStatus[tid] == ItlbWait) {
-        ++fetchTlbCycles;
+        fetchTlbCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is waiting ITLB walk to "
                 "finish!\n", tid);
     } else if (fetchStatus[tid] == TrapPending) {
-        ++fetchPendingTrapStallCycles;
+        fetchPendingTrapStallCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is waiting for a pending trap!\n",
                 tid);
     } else if (fetchStatus[tid] == QuiescePending) {
-        ++fetchPendingQuiesceStallCycles;
+        fetchPendingQuiesceStallCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is waiting for a pending quiesce "
                 "instruction!\n", tid);
     } else if (fetchStatus[tid] == IcacheWaitRetry) {
-        ++fetchIcacheWaitRetryStallCycles;
+        fetchIcacheWaitRetryStallCycles += count;
         DPRINTF(Fetch, "[tid:%i] Fetch is waiting for an I-cache retry!\n",
                 tid);
     } else if (fetchStatus[tid] == NoGoodAddr) {
@@ -296,6 +296,12 @@ class DefaultIEW
      */
     void tick();
 
+    /**
+     * Credit the stats that tick() would have recorded over cycles
+     * during which the CPU was asleep and the stage was not ticked.
+     */
+    void creditIdleCycles(Cycles cycles);
+
   private:
     /** Updates execution stats based on the instruction. */
     void updateExeInstStats(const DynInstPtr &inst);
@@ -1629,6 +1629,26 @@ DefaultIEW<Impl>::tick()
     }
 }
 
+template <class Impl>
+void
+DefaultIEW<Impl>::creditIdleCycles(Cycles cycles)
+{
+    // Mirror dispatch() for a stage with nothing to dispatch.
+    for (ThreadID tid : *activeThreads) {
+        if (dispatchStatus[tid] == Blocked) {
+            iewBlockCycles += cycles;
+        } else if (dispatchStatus[tid] == Squashing) {
+            iewSquashCycles += cycles;
+        }
+    }
+
+    if (exeStatus != Squashing)
+        instQueue.creditIdleCycles(cycles);
+
+    // updateStatus() reads the IQ once per cycle.
+    instQueue.intInstQueueReads += cycles;
+}
+
 template <class Impl>
 void
 DefaultIEW<Impl>::updateExeInstStats(const DynInstPtr& inst)
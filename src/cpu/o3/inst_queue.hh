@@ -45,10 +45,10 @@
 #define __CPU_O3_INST_QUEUE_HH__
 
 #include <list>
-#include <map>
 #include <queue>
 #include <vector>
 
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "cpu/o3/dep_graph.hh"
@@ -95,6 +95,9 @@ class InstructionQueue
     // Typedef of iterator through the list of instructions.
     typedef typename std::list<DynInstPtr>::iterator ListIt;
 
+    /** Fixed-capacity, program ordered buffer of instructions. */
+    typedef CircularQueue<DynInstPtr> InstList;
+
     /** FU completion event class. */
     class FUCompletion : public Event {
       private:
@@ -218,6 +221,12 @@ class InstructionQueue
      */
     void scheduleReadyInsts();
 
+    /**
+     * Credit the issue distribution with cycles during which the CPU
+     * was asleep and nothing could be issued.
+     */
+    void creditIdleCycles(Cycles cycles);
+
     /** Schedules a single specific non-speculative instruction. */
     void scheduleNonSpec(const InstSeqNum &inst);
 
@@ -312,11 +321,14 @@ class InstructionQueue
     // Instruction lists, ready queues, and ordering
     //////////////////////////////////////
 
-    /** List of all the instructions in the IQ (some of which may be issued). */
-    std::list<DynInstPtr> instList[Impl::MaxThreads];
+    /** List of all the instructions in the IQ (some of which may be issued).
+     *  There is one buffer per thread, ordered by sequence number, so that
+     *  commit pops from the head and squash truncates the tail.
+     */
+    std::vector<InstList> instList;
 
     /** List of instructions that are ready to be executed. */
-    std::list<DynInstPtr> instsToExecute;
+    InstList instsToExecute;
 
     /** List of instructions waiting for their DTB translation to
      *  complete (hw page table walk in progress).
@@ -353,16 +365,50 @@ class InstructionQueue
      */
     ReadyInstQueue readyInsts[Num_OpClasses];
 
+    /** Entry of the non-speculative instruction buffers. The sequence
+     *  number is kept next to the instruction so that entries removed out
+     *  of order (inst == nullptr) can still be binary searched over.
+     */
+    struct NonSpecEntry {
+        InstSeqNum seqNum;
+        DynInstPtr inst;
+    };
+
+    typedef CircularQueue<NonSpecEntry> NonSpecList;
+
     /** List of non-speculative instructions that will be scheduled
      *  once the IQ gets a signal from commit.  While it's redundant to
      *  have the key be a part of the value (the sequence number is stored
      *  inside of DynInst), when these instructions are woken up only
-     *  the sequence number will be available.  Thus it is most efficient to be
-     *  able to search by the sequence number alone.
+     *  the sequence number will be available.  Each thread inserts in
+     *  program order, so every per-thread buffer is sorted by sequence
+     *  number and can be searched by the sequence number alone.
+     */
+    std::vector<NonSpecList> nonSpecInsts;
+
+    /** Finds the entry of a non-speculative instruction.
+     *  @return The entry or nullptr if it is not (or no longer) in the IQ.
+     */
+    NonSpecEntry *findNonSpec(const InstSeqNum &seq_num);
+
+    /** Removes a non-speculative instruction from its buffer, dropping any
+     *  stale entries left at either end of it.
      */
-    std::map<InstSeqNum, DynInstPtr> nonSpecInsts;
+    void removeNonSpec(ThreadID tid, NonSpecEntry *entry);
+
+    /** Drops the stale entries left between the live ones of a thread's
+     *  buffer, keeping the live ones in order.
+     */
+    void compactNonSpec(ThreadID tid);
+
+    /** Returns the number of non-speculative instructions in the IQ. */
+    size_t numNonSpecInsts() const;
+
+    /** Appends a newly dispatched instruction to its thread's list. */
+    void insertInstList(const DynInstPtr &inst);
 
-    typedef typename std::map<InstSeqNum, DynInstPtr>::iterator NonSpecMapIt;
+    /** Appends an issued instruction to the list of insts to execute. */
+    void pushInstToExecute(const DynInstPtr &inst);
 
     /** Entry for the list age ordering by op class. */
     struct ListOrderEntry {
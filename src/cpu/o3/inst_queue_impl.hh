@@ -45,6 +45,7 @@
 #ifndef __CPU_O3_INST_QUEUE_IMPL_HH__
 #define __CPU_O3_INST_QUEUE_IMPL_HH__
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -90,6 +91,7 @@ InstructionQueue<Impl>::InstructionQueue(O3CPU *cpu_ptr, IEW *iew_ptr,
     : cpu(cpu_ptr),
       iewStage(iew_ptr),
       fuPool(params->fuPool),
+      instsToExecute(params->numROBEntries + params->numIQEntries),
       iqPolicy(params->smtIQPolicy),
       numEntries(params->numIQEntries),
       totalWidth(params->issueWidth),
@@ -120,6 +122,20 @@ InstructionQueue<Impl>::InstructionQueue(O3CPU *cpu_ptr, IEW *iew_ptr,
         memDepUnit[tid].setIQ(this);
     }
 
+    // Instructions stay on a thread's list from dispatch until commit
+    // tells the IQ that they have retired, which happens some cycles after
+    // they have left the ROB. Give the lists a ROB worth of entries plus
+    // the IQ size as slack for that delay; the same bound holds for issued
+    // instructions waiting to be executed. Non-speculative instructions
+    // are removed before they issue, so there are never more of them than
+    // the IQ size; see insertNonSpec() for the stale entries.
+    instList.reserve(Impl::MaxThreads);
+    nonSpecInsts.reserve(Impl::MaxThreads);
+    for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++) {
+        instList.emplace_back(params->numROBEntries + numEntries);
+        nonSpecInsts.emplace_back(numEntries);
+    }
+
     resetState();
 
     //Figure out resource sharing policy
@@ -399,7 +415,14 @@ InstructionQueue<Impl>::resetState()
     //Initialize thread IQ counts
     for (ThreadID tid = 0; tid < Impl::MaxThreads; tid++) {
         count[tid] = 0;
-        instList[tid].clear();
+        while (!instList[tid].empty()) {
+            instList[tid].back() = nullptr;
+            instList[tid].pop_back();
+        }
+        while (!nonSpecInsts[tid].empty()) {
+            nonSpecInsts[tid].back().inst = nullptr;
+            nonSpecInsts[tid].pop_back();
+        }
     }
 
     // Initialize the number of free IQ entries.
@@ -424,7 +447,6 @@ InstructionQueue<Impl>::resetState()
         queueOnList[i] = false;
         readyIt[i] = listOrder.end();
     }
-    nonSpecInsts.clear();
     listOrder.clear();
     deferredMemInsts.clear();
     blockedMemInsts.clear();
@@ -594,7 +616,7 @@ InstructionQueue<Impl>::insert(const DynInstPtr &new_inst)
 
     assert(freeEntries != 0);
 
-    instList[new_inst->threadNumber].push_back(new_inst);
+    insertInstList(new_inst);
 
     --freeEntries;
 
@@ -637,7 +659,19 @@ InstructionQueue<Impl>::insertNonSpec(const DynInstPtr &new_inst)
 
     assert(new_inst);
 
-    nonSpecInsts[new_inst->seqNum] = new_inst;
+    // Entries removed out of order stay behind as stale entries until
+    // they reach either end of the buffer, so those can fill it. Every
+    // live entry holds an IQ entry though, and so does new_inst, so there
+    // are less than numEntries live ones and dropping the stale entries
+    // always makes room.
+    NonSpecList &non_spec = nonSpecInsts[new_inst->threadNumber];
+    if (non_spec.full()) {
+        compactNonSpec(new_inst->threadNumber);
+    }
+    panic_if(non_spec.full(), "Non-speculative instruction list of thread "
+             "%i is full.", new_inst->threadNumber);
+    assert(non_spec.empty() || non_spec.back().seqNum < new_inst->seqNum);
+    non_spec.push_back(NonSpecEntry{new_inst->seqNum, new_inst});
 
     DPRINTF(IQ, "Adding non-speculative instruction [sn:%llu] PC %s "
             "to the IQ.\n",
@@ -645,7 +679,7 @@ InstructionQueue<Impl>::insertNonSpec(const DynInstPtr &new_inst)
 
     assert(freeEntries != 0);
 
-    instList[new_inst->threadNumber].push_back(new_inst);
+    insertInstList(new_inst);
 
     --freeEntries;
 
@@ -765,7 +799,7 @@ InstructionQueue<Impl>::processFUCompletion(const DynInstPtr &inst, int fu_idx)
     // of a cycle, otherwise they could add too many instructions to
     // the queue.
     issueToExecuteQueue->access(-1)->size++;
-    instsToExecute.push_back(inst);
+    pushInstToExecute(inst);
 }
 
 // @todo: Figure out a better way to remove the squashed items from the
@@ -859,7 +893,7 @@ InstructionQueue<Impl>::scheduleReadyInsts()
         if (idx != FUPool::NoFreeFU) {
             if (op_latency == Cycles(1)) {
                 i2e_info->size++;
-                instsToExecute.push_back(issuing_inst);
+                pushInstToExecute(issuing_inst);
 
                 // Add the FU onto the list of FU's to be freed next
                 // cycle if we used one.
@@ -929,16 +963,22 @@ InstructionQueue<Impl>::scheduleReadyInsts()
     iqInstsIssued+= total_issued;
 
     // If we issued any instructions, tell the CPU we had activity.
-    // @todo If the way deferred memory instructions are handeled due to
-    // translation changes then the deferredMemInsts condition should be removed
-    // from the code below.
-    if (total_issued || !retryMemInsts.empty() || !deferredMemInsts.empty()) {
+    // Deferred memory instructions do not keep the CPU awake; the LSQ
+    // wakes it up when their translation completes.
+    if (total_issued || !retryMemInsts.empty()) {
         cpu->activityThisCycle();
     } else {
         DPRINTF(IQ, "Not able to schedule any instructions.\n");
     }
 }
 
+template <class Impl>
+void
+InstructionQueue<Impl>::creditIdleCycles(Cycles cycles)
+{
+    numIssuedDist.sample(0, cycles);
+}
+
 template <class Impl>
 void
 InstructionQueue<Impl>::scheduleNonSpec(const InstSeqNum &inst)
@@ -946,25 +986,124 @@ InstructionQueue<Impl>::scheduleNonSpec(const InstSeqNum &inst)
     DPRINTF(IQ, "Marking nonspeculative instruction [sn:%llu] as ready "
             "to execute.\n", inst);
 
-    NonSpecMapIt inst_it = nonSpecInsts.find(inst);
+    NonSpecEntry *entry = findNonSpec(inst);
 
-    assert(inst_it != nonSpecInsts.end());
+    assert(entry);
 
-    ThreadID tid = (*inst_it).second->threadNumber;
+    DynInstPtr ns_inst = entry->inst;
+    ThreadID tid = ns_inst->threadNumber;
 
-    (*inst_it).second->setAtCommit();
+    removeNonSpec(tid, entry);
 
-    (*inst_it).second->setCanIssue();
+    ns_inst->setAtCommit();
 
-    if (!(*inst_it).second->isMemRef()) {
-        addIfReady((*inst_it).second);
+    ns_inst->setCanIssue();
+
+    if (!ns_inst->isMemRef()) {
+        addIfReady(ns_inst);
     } else {
-        memDepUnit[tid].nonSpecInstReady((*inst_it).second);
+        memDepUnit[tid].nonSpecInstReady(ns_inst);
+    }
+}
+
+template <class Impl>
+typename InstructionQueue<Impl>::NonSpecEntry *
+InstructionQueue<Impl>::findNonSpec(const InstSeqNum &seq_num)
+{
+    for (ThreadID tid = 0; tid < numThreads; ++tid) {
+        NonSpecList &non_spec = nonSpecInsts[tid];
+
+        if (non_spec.empty() || seq_num < non_spec.front().seqNum ||
+            seq_num > non_spec.back().seqNum) {
+            continue;
+        }
+
+        // Commit schedules non-speculative instructions in program order,
+        // so the one we are looking for is almost always at the head.
+        if (non_spec.front().seqNum == seq_num) {
+            return non_spec.front().inst ? &non_spec.front() : nullptr;
+        }
+
+        auto it = std::lower_bound(non_spec.begin(), non_spec.end(),
+            seq_num,
+            [](const NonSpecEntry &entry, const InstSeqNum &sn)
+            { return entry.seqNum < sn; });
+
+        if (it != non_spec.end() && it->seqNum == seq_num && it->inst) {
+            return &(*it);
+        }
+    }
+
+    return nullptr;
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::removeNonSpec(ThreadID tid, NonSpecEntry *entry)
+{
+    NonSpecList &non_spec = nonSpecInsts[tid];
+
+    entry->inst = nullptr;
+
+    while (!non_spec.empty() && !non_spec.front().inst) {
+        non_spec.pop_front();
+    }
+    while (!non_spec.empty() && !non_spec.back().inst) {
+        non_spec.pop_back();
+    }
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::compactNonSpec(ThreadID tid)
+{
+    NonSpecList &non_spec = nonSpecInsts[tid];
+
+    // Rotate the buffer once, putting back only the live entries.
+    for (size_t n = non_spec.size(); n > 0; --n) {
+        NonSpecEntry entry = std::move(non_spec.front());
+        non_spec.pop_front();
+        if (entry.inst) {
+            non_spec.push_back(std::move(entry));
+        }
     }
+}
+
+template <class Impl>
+size_t
+InstructionQueue<Impl>::numNonSpecInsts() const
+{
+    size_t num = 0;
 
-    (*inst_it).second = NULL;
+    for (ThreadID tid = 0; tid < numThreads; ++tid) {
+        for (const auto &entry : nonSpecInsts[tid]) {
+            if (entry.inst) {
+                ++num;
+            }
+        }
+    }
 
-    nonSpecInsts.erase(inst_it);
+    return num;
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::insertInstList(const DynInstPtr &inst)
+{
+    InstList &inst_list = instList[inst->threadNumber];
+
+    panic_if(inst_list.full(), "IQ instruction list of thread %i is full.",
+             inst->threadNumber);
+    inst_list.push_back(inst);
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::pushInstToExecute(const DynInstPtr &inst)
+{
+    panic_if(instsToExecute.full(), "IQ list of instructions to execute "
+             "is full.");
+    instsToExecute.push_back(inst);
 }
 
 template <class Impl>
@@ -974,12 +1113,11 @@ InstructionQueue<Impl>::commit(const InstSeqNum &inst, ThreadID tid)
     DPRINTF(IQ, "[tid:%i] Committing instructions older than [sn:%llu]\n",
             tid,inst);
 
-    ListIt iq_it = instList[tid].begin();
+    InstList &inst_list = instList[tid];
 
-    while (iq_it != instList[tid].end() &&
-           (*iq_it)->seqNum <= inst) {
-        ++iq_it;
-        instList[tid].pop_front();
+    while (!inst_list.empty() && inst_list.front()->seqNum <= inst) {
+        inst_list.front() = nullptr;
+        inst_list.pop_front();
     }
 
     assert(freeEntries == (numEntries - countInsts()));
@@ -1224,19 +1362,19 @@ template <class Impl>
 void
 InstructionQueue<Impl>::doSquash(ThreadID tid)
 {
-    // Start at the tail.
-    ListIt squash_it = instList[tid].end();
-    --squash_it;
+    InstList &inst_list = instList[tid];
 
     DPRINTF(IQ, "[tid:%i] Squashing until sequence number %i!\n",
             tid, squashedSeqNum[tid]);
 
     // Squash any instructions younger than the squashed sequence number
-    // given.
-    while (squash_it != instList[tid].end() &&
-           (*squash_it)->seqNum > squashedSeqNum[tid]) {
+    // given. They are all at the tail of the list, so start there and pop
+    // them off as we go.
+    while (!inst_list.empty() &&
+           inst_list.back()->seqNum > squashedSeqNum[tid]) {
 
-        DynInstPtr squashed_inst = (*squash_it);
+        DynInstPtr squashed_inst = std::move(inst_list.back());
+        inst_list.pop_back();
         if (squashed_inst->isFloating()) {
             fpInstQueueWrites++;
         } else if (squashed_inst->isVector()) {
@@ -1249,7 +1387,6 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
         // hasn't already been squashed in the IQ.
         if (squashed_inst->threadNumber != tid ||
             squashed_inst->isSquashedInIQ()) {
-            --squash_it;
             continue;
         }
 
@@ -1301,13 +1438,12 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
 
             } else if (!squashed_inst->isStoreConditional() ||
                        !squashed_inst->isCompleted()) {
-                NonSpecMapIt ns_inst_it =
-                    nonSpecInsts.find(squashed_inst->seqNum);
+                NonSpecEntry *ns_entry = findNonSpec(squashed_inst->seqNum);
 
                 // we remove non-speculative instructions from
                 // nonSpecInsts already when they are ready, and so we
                 // cannot always expect to find them
-                if (ns_inst_it == nonSpecInsts.end()) {
+                if (!ns_entry) {
                     // loads that became ready but stalled on a
                     // blocked cache are alreayd removed from
                     // nonSpecInsts, and have not faulted
@@ -1315,9 +1451,7 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
                            squashed_inst->isMemRef());
                 } else {
 
-                    (*ns_inst_it).second = NULL;
-
-                    nonSpecInsts.erase(ns_inst_it);
+                    removeNonSpec(tid, ns_entry);
 
                     ++iqSquashedNonSpecRemoved;
                 }
@@ -1359,7 +1493,6 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
             assert(dependGraph.empty(dest_reg->flatIndex()));
             dependGraph.clearInst(dest_reg->flatIndex());
         }
-        instList[tid].erase(squash_it--);
         ++iqSquashedInstsExamined;
     }
 }
@@ -1505,17 +1638,17 @@ InstructionQueue<Impl>::dumpLists()
         cprintf("\n");
     }
 
-    cprintf("Non speculative list size: %i\n", nonSpecInsts.size());
-
-    NonSpecMapIt non_spec_it = nonSpecInsts.begin();
-    NonSpecMapIt non_spec_end_it = nonSpecInsts.end();
+    cprintf("Non speculative list size: %i\n", numNonSpecInsts());
 
     cprintf("Non speculative list: ");
 
-    while (non_spec_it != non_spec_end_it) {
-        cprintf("%s [sn:%llu]", (*non_spec_it).second->pcState(),
-                (*non_spec_it).second->seqNum);
-        ++non_spec_it;
+    for (ThreadID tid = 0; tid < numThreads; ++tid) {
+        for (const auto &entry : nonSpecInsts[tid]) {
+            if (entry.inst) {
+                cprintf("%s [sn:%llu]", entry.inst->pcState(),
+                        entry.seqNum);
+            }
+        }
     }
 
     cprintf("\n");
@@ -1545,7 +1678,7 @@ InstructionQueue<Impl>::dumpInsts()
     for (ThreadID tid = 0; tid < numThreads; ++tid) {
         int num = 0;
         int valid_num = 0;
-        ListIt inst_list_it = instList[tid].begin();
+        auto inst_list_it = instList[tid].begin();
 
         while (inst_list_it != instList[tid].end()) {
             cprintf("Instruction:%i\n", num);
@@ -1585,7 +1718,7 @@ InstructionQueue<Impl>::dumpInsts()
 
     int num = 0;
     int valid_num = 0;
-    ListIt inst_list_it = instsToExecute.begin();
+    auto inst_list_it = instsToExecute.begin();
 
     while (inst_list_it != instsToExecute.end())
     {
@@ -785,6 +785,11 @@ LSQ<Impl>::SingleDataRequest::finish(const Fault &fault, const RequestPtr &req,
 
         LSQRequest::_inst->fault = fault;
         LSQRequest::_inst->translationCompleted(true);
+
+        // The IQ does not keep the CPU ticking while a translation is
+        // outstanding, so wake it up to retry the deferred instruction.
+        if (this->isDelayed())
+            _inst->cpu->wakeCPU();
     }
 }
 
@@ -827,6 +832,10 @@ LSQ<Impl>::SplitDataRequest::finish(const Fault &fault, const RequestPtr &req,
                 _inst->fault = *fault_it;
             }
             _inst->translationCompleted(true);
+
+            // See SingleDataRequest::finish().
+            if (this->isDelayed())
+                _inst->cpu->wakeCPU();
         }
     }
 }
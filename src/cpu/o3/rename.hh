@@ -201,6 +201,12 @@ class DefaultRename
      */
     void tick();
 
+    /**
+     * Credit the stats that tick() would have recorded over cycles
+     * during which the CPU was asleep and the stage was not ticked.
+     */
+    void creditIdleCycles(Cycles cycles);
+
     /** Debugging function used to dump history buffer of renamings. */
     void dumpHistory();
 
@@ -488,6 +488,25 @@ DefaultRename<Impl>::tick()
 
 }
 
+template <class Impl>
+void
+DefaultRename<Impl>::creditIdleCycles(Cycles cycles)
+{
+    // Mirror rename() for a stage with nothing to rename.
+    for (ThreadID tid : *activeThreads) {
+        if (renameStatus[tid] == Blocked) {
+            renameBlockCycles += cycles;
+        } else if (renameStatus[tid] == Squashing) {
+            renameSquashCycles += cycles;
+        } else if (renameStatus[tid] == SerializeStall) {
+            renameSerializeStallCycles += cycles;
+        } else if (renameStatus[tid] == Running ||
+                   renameStatus[tid] == Idle) {
+            renameIdleCycles += cycles;
+        }
+    }
+}
+
 template<class Impl>
 void
 DefaultRename<Impl>::rename(bool &status_change, ThreadID tid)
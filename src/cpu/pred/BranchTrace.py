@@ -0,0 +1,49 @@
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.SimObject import SimObject
+from m5.params import *
+from m5.objects.Probe import ProbeListenerObject
+
+class BranchTraceRecorder(ProbeListenerObject):
+    type = 'BranchTraceRecorder'
+    cxx_header = 'cpu/pred/branch_trace_recorder.hh'
+
+    # The manager is the branch predictor whose committed branches are
+    # traced.
+    traceFile = Param.String("branches.trc.gz", "Protobuf trace file name, "
+                             "relative to the output directory")
+
+class BranchTraceReplayer(SimObject):
+    type = 'BranchTraceReplayer'
+    cxx_header = 'cpu/pred/branch_trace_replayer.hh'
+
+    traceFile = Param.String("Branch trace recorded by a BranchTraceRecorder")
+    predictors = VectorParam.BranchPredictor("Branch predictors to evaluate")
+    hostThreads = Param.Unsigned(0, "Number of host threads to replay on, "
+                                 "0 for one per predictor")
+    seed = Param.UInt32(5489, "Seed of the random number generator at the "
+                        "start of each replay")
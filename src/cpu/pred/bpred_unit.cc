@@ -51,8 +51,11 @@
 #include "arch/utility.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
+#include "cpu/pred/bpred_random.hh"
 #include "debug/Branch.hh"
 
+__thread Random *bpredThreadRandom = nullptr;
+
 BPredUnit::BPredUnit(const Params *params)
     : SimObject(params),
       numThreads(params->numThreads),
@@ -157,6 +160,9 @@ BPredUnit::regProbePoints()
 {
     ppBranches = pmuProbePoint("Branches");
     ppMisses = pmuProbePoint("Misses");
+
+    ppCommitted.reset(new ProbePointArg<CommittedBranch>(
+                          getProbeManager(), "Committed"));
 }
 
 void
@@ -349,6 +355,13 @@ BPredUnit::update(const InstSeqNum &done_sn, ThreadID tid)
 
     while (!predHist[tid].empty() &&
            predHist[tid].back().seqNum <= done_sn) {
+        // A squash has corrected the direction and target of the entry
+        // by now, so they are the architectural outcome of the branch.
+        ppCommitted->notify(CommittedBranch {
+                tid, predHist[tid].back().pc, predHist[tid].back().target,
+                predHist[tid].back().predTaken,
+                predHist[tid].back().inst.get() });
+
         // Update the branch predictor with the correct results.
         update(tid, predHist[tid].back().pc,
                     predHist[tid].back().predTaken,
@@ -48,6 +48,7 @@
 #define __CPU_PRED_BPRED_UNIT_HH__
 
 #include <deque>
+#include <memory>
 
 #include "base/statistics.hh"
 #include "base/types.hh"
@@ -58,6 +59,7 @@
 #include "cpu/static_inst.hh"
 #include "params/BranchPredictor.hh"
 #include "sim/probe/pmu.hh"
+#include "sim/probe/probe.hh"
 #include "sim/sim_object.hh"
 
 /**
@@ -68,6 +70,26 @@ class BPredUnit : public SimObject
 {
   public:
       typedef BranchPredictorParams Params;
+
+    /**
+     * A branch whose prediction is retired by update(), as reported
+     * through the Committed probe point. All fields describe the
+     * architectural outcome of the branch.
+     */
+    struct CommittedBranch
+    {
+        /** The thread the branch belongs to. */
+        ThreadID tid;
+        /** PC of the branch. */
+        Addr pc;
+        /** PC of the instruction executed after the branch. */
+        Addr nextPC;
+        /** Whether or not the branch was taken. */
+        bool taken;
+        /** The branch instruction. */
+        const StaticInst *inst;
+    };
+
     /**
      * @param params The params object, that has the size of the BP and BTB.
      */
@@ -345,6 +367,9 @@ class BPredUnit : public SimObject
     /** Miss-predicted branches */
     ProbePoints::PMUUPtr ppMisses;
 
+    /** Branches retired from the predictor history at commit */
+    std::unique_ptr<ProbePointArg<CommittedBranch>> ppCommitted;
+
     /** @} */
 };
 
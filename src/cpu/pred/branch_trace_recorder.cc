@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/branch_trace_recorder.hh"
+
+#include "base/callback.hh"
+#include "base/output.hh"
+#include "proto/branch.pb.h"
+#include "sim/sim_exit.hh"
+
+BranchTraceRecorder::BranchTraceRecorder(
+        const BranchTraceRecorderParams *params)
+    : ProbeListenerObject(params), traceStream(nullptr)
+{
+    fatal_if(params->traceFile == "", "%s: traceFile must be set.\n",
+             name());
+
+    traceStream = new ProtoOutputStream(simout.resolve(params->traceFile));
+
+    ProtoMessage::BranchHeader header;
+    header.set_obj_id(name());
+    traceStream->write(header);
+
+    registerExitCallback(
+        new MakeCallback<BranchTraceRecorder,
+                         &BranchTraceRecorder::close>(this));
+}
+
+void
+BranchTraceRecorder::regProbeListeners()
+{
+    typedef ProbeListenerArg<BranchTraceRecorder,
+            BPredUnit::CommittedBranch> BranchListener;
+    listeners.push_back(new BranchListener(this, "Committed",
+                &BranchTraceRecorder::record));
+}
+
+uint32_t
+BranchTraceRecorder::type(const StaticInst &inst)
+{
+    uint32_t type = 0;
+    if (inst.isCondCtrl())
+        type |= Conditional;
+    if (inst.isUncondCtrl())
+        type |= Unconditional;
+    if (inst.isDirectCtrl())
+        type |= Direct;
+    if (inst.isIndirectCtrl())
+        type |= Indirect;
+    if (inst.isCall())
+        type |= Call;
+    if (inst.isReturn())
+        type |= Return;
+    return type;
+}
+
+void
+BranchTraceRecorder::record(const BPredUnit::CommittedBranch &branch)
+{
+    if (!traceStream)
+        return;
+
+    ProtoMessage::Branch msg;
+    msg.set_pc(branch.pc);
+    msg.set_next_pc(branch.nextPC);
+    msg.set_taken(branch.taken);
+    msg.set_type(type(*branch.inst));
+    if (branch.tid != 0)
+        msg.set_tid(branch.tid);
+    traceStream->write(msg);
+}
+
+void
+BranchTraceRecorder::close()
+{
+    delete traceStream;
+    traceStream = nullptr;
+}
+
+BranchTraceRecorder *
+BranchTraceRecorderParams::create()
+{
+    return new BranchTraceRecorder(this);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of a probe listener that writes the branches committed
+ * through a BPredUnit to a protobuf trace. The trace can be replayed
+ * through other predictors with BranchTraceReplayer.
+ */
+
+#ifndef __CPU_PRED_BRANCH_TRACE_RECORDER_HH__
+#define __CPU_PRED_BRANCH_TRACE_RECORDER_HH__
+
+#include <cstdint>
+
+#include "cpu/pred/bpred_unit.hh"
+#include "params/BranchTraceRecorder.hh"
+#include "proto/protoio.hh"
+#include "sim/probe/probe.hh"
+
+class BranchTraceRecorder : public ProbeListenerObject
+{
+  public:
+    /** Bits of the type field of a trace record. */
+    enum Type : uint32_t
+    {
+        Conditional = 1 << 0,
+        Unconditional = 1 << 1,
+        Direct = 1 << 2,
+        Indirect = 1 << 3,
+        Call = 1 << 4,
+        Return = 1 << 5,
+    };
+
+    BranchTraceRecorder(const BranchTraceRecorderParams *params);
+
+    /** Register the listener with the Committed probe of the manager. */
+    void regProbeListeners() override;
+
+    /** Encode the control flags of a branch instruction. */
+    static uint32_t type(const StaticInst &inst);
+
+  private:
+    /** Write a trace record for a committed branch. */
+    void record(const BPredUnit::CommittedBranch &branch);
+
+    /** Close the trace at the end of the simulation. */
+    void close();
+
+    /** The output trace, or nullptr once closed. */
+    ProtoOutputStream *traceStream;
+};
+
+#endif // __CPU_PRED_BRANCH_TRACE_RECORDER_HH__
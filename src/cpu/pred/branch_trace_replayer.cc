@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/branch_trace_replayer.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+#include "arch/types.hh"
+#include "base/trace.hh"
+#include "config/the_isa.hh"
+#include "cpu/pred/bpred_random.hh"
+#include "cpu/pred/branch_trace_recorder.hh"
+#include "cpu/static_inst.hh"
+#include "proto/branch.pb.h"
+#include "proto/protoio.hh"
+#include "sim/sim_exit.hh"
+
+namespace
+{
+
+TheISA::ExtMachInst traceMachInst;
+
+/**
+ * Stand-in for a branch instruction of the trace. It carries the control
+ * flags the predictors look at and knows its fall-through PC.
+ */
+class TraceBranchInst : public StaticInst
+{
+  private:
+    const Addr fallThrough;
+
+  public:
+    TraceBranchInst(uint32_t type, Addr fall_through)
+        : StaticInst("trace branch", traceMachInst, No_OpClass),
+          fallThrough(fall_through)
+    {
+        flags[IsControl] = true;
+        flags[IsCondControl] = type & BranchTraceRecorder::Conditional;
+        flags[IsUncondControl] = type & BranchTraceRecorder::Unconditional;
+        flags[IsDirectControl] = type & BranchTraceRecorder::Direct;
+        flags[IsIndirectControl] = type & BranchTraceRecorder::Indirect;
+        flags[IsCall] = type & BranchTraceRecorder::Call;
+        flags[IsReturn] = type & BranchTraceRecorder::Return;
+    }
+
+    Fault
+    execute(ExecContext *xc, Trace::InstRecord *traceData) const override
+    {
+        panic("Trace branches can't be executed.\n");
+    }
+
+    void
+    advancePC(TheISA::PCState &pc_state) const override
+    {
+        pc_state.set(fallThrough);
+    }
+
+    std::string
+    generateDisassembly(Addr pc, const SymbolTable *symtab) const override
+    {
+        return mnemonic;
+    }
+};
+
+} // anonymous namespace
+
+BranchTraceReplayer::BranchTraceReplayer(
+        const BranchTraceReplayerParams *params)
+    : SimObject(params),
+      predictors(params->predictors),
+      hostThreads(params->hostThreads ? params->hostThreads :
+                  params->predictors.size()),
+      seed(params->seed),
+      replayEvent([this]{ replay(); }, name())
+{
+    fatal_if(predictors.empty(), "%s: No predictors to evaluate.\n",
+             name());
+
+    loadTrace(params->traceFile);
+
+    ThreadID max_tid = 0;
+    for (const auto &rec : trace)
+        max_tid = std::max(max_tid, rec.tid);
+
+    for (auto bp : predictors) {
+        auto bp_params =
+            static_cast<const BranchPredictorParams *>(bp->params());
+        fatal_if(max_tid >= bp_params->numThreads,
+                 "%s: Trace has branches of thread %d but %s only has %d "
+                 "threads.\n", name(), max_tid, bp->name(),
+                 bp_params->numThreads);
+    }
+}
+
+void
+BranchTraceReplayer::loadTrace(const std::string &filename)
+{
+    ProtoInputStream stream(filename);
+
+    ProtoMessage::BranchHeader header;
+    fatal_if(!stream.read(header), "%s: Failed to read the header of %s.\n",
+             name(), filename);
+
+    std::unordered_map<Addr, uint32_t> site_index;
+    ProtoMessage::Branch msg;
+    while (stream.read(msg)) {
+        auto ins = site_index.emplace(msg.pc(), sites.size());
+        if (ins.second)
+            sites.push_back(Site { msg.pc(), msg.type(), msg.pc() });
+
+        Site &site = sites[ins.first->second];
+        if (!msg.taken())
+            site.fallThrough = msg.next_pc();
+
+        trace.push_back(Record { msg.pc(), msg.next_pc(), ins.first->second,
+                                 ThreadID(msg.tid()), msg.taken() });
+    }
+
+    inform("%s: Loaded %d branches at %d PCs from %s.\n", name(),
+           trace.size(), sites.size(), filename);
+}
+
+void
+BranchTraceReplayer::regStats()
+{
+    SimObject::regStats();
+
+    branches
+        .name(name() + ".branches")
+        .desc("Number of branches replayed through each predictor")
+        ;
+
+    mispredicted
+        .init(predictors.size())
+        .name(name() + ".mispredicted")
+        .desc("Number of mispredicted branches")
+        .flags(Stats::total)
+        ;
+
+    mispredictRate
+        .name(name() + ".mispredictRate")
+        .desc("Fraction of mispredicted branches")
+        .precision(6)
+        ;
+    mispredictRate = mispredicted / branches;
+
+    for (int i = 0; i < predictors.size(); i++) {
+        mispredicted.subname(i, predictors[i]->name());
+        mispredictRate.subname(i, predictors[i]->name());
+    }
+}
+
+void
+BranchTraceReplayer::startup()
+{
+    schedule(replayEvent, curTick());
+}
+
+Counter
+BranchTraceReplayer::replayThrough(BPredUnit &bp) const
+{
+    // Give every predictor the same random sequence, whichever thread
+    // replays it, without touching random_mt.
+    Random rng(seed);
+    bpredThreadRandom = &rng;
+
+    // Instructions are reference counted, so every replay needs its own.
+    std::vector<StaticInstPtr> insts;
+    insts.reserve(sites.size());
+    for (const auto &site : sites)
+        insts.push_back(new TraceBranchInst(site.type, site.fallThrough));
+
+    Counter misses = 0;
+    InstSeqNum seq_num = 0;
+    for (const auto &rec : trace) {
+        ++seq_num;
+
+        TheISA::PCState pc(rec.pc);
+        bool pred_taken = bp.predict(insts[rec.site], seq_num, pc, rec.tid);
+
+        if (pred_taken != rec.taken ||
+            (rec.taken && pc.instAddr() != rec.nextPC)) {
+            ++misses;
+            bp.squash(seq_num, TheISA::PCState(rec.nextPC), rec.taken,
+                      rec.tid);
+        }
+
+        bp.update(seq_num, rec.tid);
+    }
+
+    bpredThreadRandom = nullptr;
+    return misses;
+}
+
+void
+BranchTraceReplayer::replay()
+{
+    std::vector<Counter> misses(predictors.size());
+    std::atomic<size_t> next(0);
+
+    auto worker = [this, &misses, &next]() {
+        // Debug output wants to know the current tick.
+        curEventQueue(eventQueue());
+
+        for (size_t i = next++; i < predictors.size(); i = next++)
+            misses[i] = replayThrough(*predictors[i]);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    const unsigned num_threads =
+        std::min<size_t>(hostThreads, predictors.size());
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; i++)
+        threads.emplace_back(worker);
+    for (auto &t : threads)
+        t.join();
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    branches = trace.size();
+    for (int i = 0; i < predictors.size(); i++)
+        mispredicted[i] = misses[i];
+
+    inform("%s: Replayed %d branches through %d predictors on %d threads "
+           "in %.2fs (%.2f Mbranches/s).\n", name(), trace.size(),
+           predictors.size(), num_threads, elapsed.count(),
+           trace.size() * predictors.size() / elapsed.count() / 1e6);
+
+    exitSimLoop("branch trace replay complete");
+}
+
+BranchTraceReplayer *
+BranchTraceReplayerParams::create()
+{
+    return new BranchTraceReplayer(this);
+}
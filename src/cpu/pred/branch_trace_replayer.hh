@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of a driver that replays a branch trace recorded by
+ * BranchTraceRecorder through a set of branch predictors, without
+ * simulating a CPU. Each predictor is replayed on its own host thread.
+ */
+
+#ifndef __CPU_PRED_BRANCH_TRACE_REPLAYER_HH__
+#define __CPU_PRED_BRANCH_TRACE_REPLAYER_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/pred/bpred_unit.hh"
+#include "params/BranchTraceReplayer.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+class BranchTraceReplayer : public SimObject
+{
+  public:
+    BranchTraceReplayer(const BranchTraceReplayerParams *params);
+
+    void regStats() override;
+
+    void startup() override;
+
+  private:
+    /** A static branch of the trace. */
+    struct Site
+    {
+        Addr pc;
+        /** Control flags, see BranchTraceRecorder::Type. */
+        uint32_t type;
+        /** Fall-through PC, or the branch PC if never seen not taken. */
+        Addr fallThrough;
+    };
+
+    /** A dynamic branch of the trace. */
+    struct Record
+    {
+        Addr pc;
+        Addr nextPC;
+        /** Index of the branch in sites. */
+        uint32_t site;
+        ThreadID tid;
+        bool taken;
+    };
+
+    /** Read the whole trace into memory. */
+    void loadTrace(const std::string &filename);
+
+    /** Replay the trace through all predictors and exit. */
+    void replay();
+
+    /**
+     * Replay the trace through one predictor, resolving each branch
+     * right after predicting it.
+     * @return The number of mispredicted branches.
+     */
+    Counter replayThrough(BPredUnit &bp) const;
+
+    const std::vector<BPredUnit *> predictors;
+
+    /** Host threads to replay on. */
+    const unsigned hostThreads;
+
+    /** Seed of the predictors' generator at the start of each replay. */
+    const uint32_t seed;
+
+    std::vector<Site> sites;
+    std::vector<Record> trace;
+
+    EventFunctionWrapper replayEvent;
+
+    /** Number of branches replayed through each predictor. */
+    Stats::Scalar branches;
+    /** Mispredicted branches, per predictor. */
+    Stats::Vector mispredicted;
+    /** Fraction of mispredicted branches, per predictor. */
+    Stats::Formula mispredictRate;
+};
+
+#endif // __CPU_PRED_BRANCH_TRACE_REPLAYER_HH__
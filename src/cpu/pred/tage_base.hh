@@ -51,6 +51,7 @@
 #ifndef __CPU_PRED_TAGE_BASE
 #define __CPU_PRED_TAGE_BASE
 
+#include <algorithm>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -80,32 +81,92 @@ class TAGEBase : public SimObject
     // Folded History Table - compressed history
     // to mix with instruction PC to index partially
     // tagged tables.
-    struct FoldedHistory
+    // Every tagged table has three of them, one for the index and two
+    // for the tag. The ones of all the tables are kept as a structure of
+    // arrays, laid out like the ci, ct0 and ct1 arrays of BranchInfo, so
+    // that they are all updated by a single loop the compiler can
+    // vectorize, and saved and restored with a single copy.
+    struct FoldedHistories
     {
-        unsigned comp;
-        int compLength;
-        int origLength;
-        int outpoint;
-        int bufferSize;
+        int numBanks;
+        std::vector<unsigned> comp;
+        std::vector<unsigned> compMask;
+        std::vector<unsigned> outBit;
+        std::vector<int> origLength;
+        // Scratch space for update()
+        std::vector<unsigned> leaving;
+
+        FoldedHistories() : numBanks(0) {}
+
+        // Allocate the histories of num_banks tables. The ones of the
+        // bimodal table (bank 0) have a zero mask, so they stay at 0.
+        void resize(int num_banks)
+        {
+            numBanks = num_banks;
+            comp.assign(3 * num_banks, 0);
+            compMask.assign(3 * num_banks, 0);
+            outBit.assign(3 * num_banks, 0);
+            origLength.assign(3 * num_banks, 0);
+            leaving.assign(3 * num_banks, 0);
+        }
+
+        void init(int bank, int original_length, int index_length,
+                  int tag0_length, int tag1_length)
+        {
+            initOne(bank, original_length, index_length);
+            initOne(numBanks + bank, original_length, tag0_length);
+            initOne(2 * numBanks + bank, original_length, tag1_length);
+        }
+
+        unsigned ci(int bank) const { return comp[bank]; }
+        unsigned ct0(int bank) const { return comp[numBanks + bank]; }
+        unsigned ct1(int bank) const { return comp[2 * numBanks + bank]; }
+
+        // Shift the newest outcome h[0] into every folded history, and
+        // the one leaving each history window out of it. The leaving
+        // outcomes are gathered first, as loads through h could alias
+        // the folded histories and keep the second loop, which has no
+        // per element shift amounts, from being vectorized. The bit
+        // shifted out at the top of a history is folded back into bit 0,
+        // which is what the comparison with the mask computes.
+        void update(const uint8_t * h)
+        {
+            const size_t n = comp.size();
+            const int *olen = origLength.data();
+            unsigned *l = leaving.data();
+            for (size_t i = 0; i < n; i++)
+                l[i] = 0U - h[olen[i]];
+
+            unsigned *c = comp.data();
+            const unsigned *mask = compMask.data();
+            const unsigned *out = outBit.data();
+            const unsigned newest = h[0];
+            for (size_t i = 0; i < n; i++) {
+                unsigned v = (c[i] << 1) | newest;
+                v ^= out[i] & l[i];
+                v ^= v > mask[i];
+                c[i] = v & mask[i];
+            }
+        }
 
-        FoldedHistory()
+        // Save to/restore from the ci, ct0 and ct1 arrays of a
+        // BranchInfo, which are contiguous.
+        void save(int *folded) const
         {
-            comp = 0;
+            std::copy(comp.begin(), comp.end(), folded);
         }
 
-        void init(int original_length, int compressed_length)
+        void restore(const int *folded)
         {
-            origLength = original_length;
-            compLength = compressed_length;
-            outpoint = original_length % compressed_length;
+            std::copy(folded, folded + comp.size(), comp.begin());
         }
 
-        void update(uint8_t * h)
+      private:
+        void initOne(int i, int original_length, int compressed_length)
         {
-            comp = (comp << 1) | h[0];
-            comp ^= h[origLength] << outpoint;
-            comp ^= (comp >> compLength);
-            comp &= (ULL(1) << compLength) - 1;
+            origLength[i] = original_length;
+            compMask[i] = (ULL(1) << compressed_length) - 1;
+            outBit[i] = 1U << (original_length % compressed_length);
         }
     };
 
@@ -165,7 +226,7 @@ class TAGEBase : public SimObject
               provider(-1)
         {
             int sz = tage.nHistoryTables + 1;
-            storage = new int [sz * 5];
+            storage = new int [sz * 5]();
             tableIndices = storage;
             tableTags = storage + sz;
             ci = tableTags + sz;
@@ -444,8 +505,7 @@ class TAGEBase : public SimObject
         int ptGhist;
 
         // Speculative folded histories.
-        FoldedHistory *computeIndices;
-        FoldedHistory *computeTags[2];
+        FoldedHistories folded;
     };
 
     std::vector<ThreadHistory> threadHistory;
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "cpu/pred/tage_base.hh"
+
+/** Gives the tests access to the protected folded histories. */
+class TAGEBaseTest : public TAGEBase
+{
+  public:
+    using TAGEBase::FoldedHistories;
+};
+
+typedef TAGEBaseTest::FoldedHistories FoldedHistories;
+
+namespace
+{
+
+/**
+ * Fold the newest original_length outcomes of a history from scratch:
+ * the outcome of age i is xor-ed into bit i % compressed_length.
+ */
+unsigned
+fold(const uint8_t *h, int original_length, int compressed_length)
+{
+    unsigned comp = 0;
+    for (int i = 0; i < original_length; i++)
+        comp ^= unsigned(h[i]) << (i % compressed_length);
+    return comp;
+}
+
+/** Geometric history lengths and the table widths of the default TAGE. */
+struct Geometry
+{
+    int numBanks;
+    std::vector<int> histLengths;
+    std::vector<int> indexLengths;
+    std::vector<int> tagLengths;
+
+    Geometry() : numBanks(8)
+    {
+        histLengths = { 0, 5, 9, 15, 25, 44, 76, 130 };
+        indexLengths = { 0, 9, 9, 9, 9, 9, 9, 9 };
+        tagLengths = { 0, 9, 9, 10, 10, 11, 11, 12 };
+    }
+
+    void
+    init(FoldedHistories &folded) const
+    {
+        folded.resize(numBanks);
+        for (int i = 1; i < numBanks; i++) {
+            folded.init(i, histLengths[i], indexLengths[i],
+                        tagLengths[i], tagLengths[i] - 1);
+        }
+    }
+};
+
+/**
+ * A global history buffer which grows downwards, like the one of
+ * TAGEBase, so that h[0] is the newest outcome.
+ */
+class History
+{
+  private:
+    std::vector<uint8_t> buffer;
+    size_t pos;
+
+  public:
+    History(size_t size) : buffer(size, 0), pos(size / 2) {}
+
+    const uint8_t *
+    push(uint8_t taken)
+    {
+        if (pos == 0) {
+            std::copy(buffer.begin(), buffer.begin() + buffer.size() / 2,
+                      buffer.begin() + buffer.size() / 2);
+            pos = buffer.size() / 2;
+        }
+        buffer[--pos] = taken;
+        return &buffer[pos];
+    }
+};
+
+} // anonymous namespace
+
+/** New histories, and the ones of the bimodal table, stay zero. */
+TEST(TAGEFoldedHistoriesTest, Zero)
+{
+    Geometry geometry;
+    FoldedHistories folded;
+    geometry.init(folded);
+    History history(1024);
+
+    for (int i = 0; i < geometry.numBanks; i++) {
+        EXPECT_EQ(folded.ci(i), 0);
+        EXPECT_EQ(folded.ct0(i), 0);
+        EXPECT_EQ(folded.ct1(i), 0);
+    }
+
+    for (int n = 0; n < 200; n++)
+        folded.update(history.push(1));
+    EXPECT_EQ(folded.ci(0), 0);
+    EXPECT_EQ(folded.ct0(0), 0);
+    EXPECT_EQ(folded.ct1(0), 0);
+}
+
+/**
+ * After every update of a random branch stream, each folded history
+ * matches the history folded from scratch. That includes histories
+ * shorter than their compressed length, and ones whose length is a
+ * multiple of it.
+ */
+TEST(TAGEFoldedHistoriesTest, MatchesFoldedHistory)
+{
+    Geometry geometry;
+    geometry.histLengths[1] = 8;
+    geometry.histLengths[2] = 18;
+    FoldedHistories folded;
+    geometry.init(folded);
+    History history(1024);
+    std::mt19937 rng(1);
+
+    for (int n = 0; n < 10000; n++) {
+        const uint8_t *h = history.push(rng() & 1);
+        folded.update(h);
+
+        for (int i = 1; i < geometry.numBanks; i++) {
+            int len = geometry.histLengths[i];
+            ASSERT_EQ(folded.ci(i), fold(h, len, geometry.indexLengths[i]))
+                << "bank " << i << " after " << n << " updates";
+            ASSERT_EQ(folded.ct0(i), fold(h, len, geometry.tagLengths[i]))
+                << "bank " << i << " after " << n << " updates";
+            ASSERT_EQ(folded.ct1(i),
+                      fold(h, len, geometry.tagLengths[i] - 1))
+                << "bank " << i << " after " << n << " updates";
+        }
+    }
+}
+
+/** Saving and restoring round trips through the BranchInfo layout. */
+TEST(TAGEFoldedHistoriesTest, SaveRestore)
+{
+    Geometry geometry;
+    FoldedHistories folded;
+    geometry.init(folded);
+    History history(1024);
+    std::mt19937 rng(2);
+
+    for (int n = 0; n < 300; n++)
+        folded.update(history.push(rng() & 1));
+
+    std::vector<int> saved(3 * geometry.numBanks);
+    folded.save(saved.data());
+    for (int i = 0; i < geometry.numBanks; i++) {
+        EXPECT_EQ(saved[i], folded.ci(i));
+        EXPECT_EQ(saved[geometry.numBanks + i], folded.ct0(i));
+        EXPECT_EQ(saved[2 * geometry.numBanks + i], folded.ct1(i));
+    }
+
+    FoldedHistories speculative = folded;
+    for (int n = 0; n < 50; n++)
+        speculative.update(history.push(rng() & 1));
+    speculative.restore(saved.data());
+    for (int i = 0; i < geometry.numBanks; i++) {
+        EXPECT_EQ(speculative.ci(i), folded.ci(i));
+        EXPECT_EQ(speculative.ct0(i), folded.ct0(i));
+        EXPECT_EQ(speculative.ct1(i), folded.ct1(i));
+    }
+}
@@ -124,6 +124,13 @@ GarnetSyntheticTraffic::init()
     numPacketsSent = 0;
 }
 
+void
+GarnetSyntheticTraffic::setInjRate(double rate)
+{
+    fatal_if(rate < 0 || rate > 1,
+             "%s: injection rate %f is not between 0 and 1\n", name(), rate);
+    injRate = rate;
+}
 
 void
 GarnetSyntheticTraffic::completeRequest(PacketPtr pkt)
@@ -173,7 +180,7 @@ GarnetSyntheticTraffic::tick()
     }
 
     // Schedule wakeup
-    if (curTick() >= simCycles)
+    if (simCycles && curTick() >= simCycles)
         exitSimLoop("Network Tester completed simCycles");
     else {
         if (!tickEvent.scheduled())
@@ -73,6 +73,16 @@ class GarnetSyntheticTraffic : public ClockedObject
      */
     void printAddr(Addr a);
 
+    /**
+     * Change the injection rate while the simulation is running. Used
+     * by the injection rate sweep in garnet_synth_traffic.py, which
+     * sets the rate to zero to drain the network between points.
+     */
+    void setInjRate(double rate);
+
+    /** Packets handed to the memory system since the start. */
+    int getNumPacketsSent() const { return numPacketsSent; }
+
   protected:
     EventFunctionWrapper tickEvent;
 
@@ -118,6 +128,7 @@ class GarnetSyntheticTraffic : public ClockedObject
     Tick noResponseCycles;
 
     int numDestinations;
+    /** Tick to stop at, or 0 to run until something else stops */
     Tick simCycles;
     int numPacketsMax;
     int numPacketsSent;
@@ -27,6 +27,7 @@
 # Authors: Tushar Krishna
 
 from m5.objects.ClockedObject import ClockedObject
+from m5.SimObject import *
 from m5.params import *
 from m5.proxy import *
 
@@ -34,10 +35,18 @@ class GarnetSyntheticTraffic(ClockedObject):
     type = 'GarnetSyntheticTraffic'
     cxx_header = \
         "cpu/testers/garnet_synthetic_traffic/GarnetSyntheticTraffic.hh"
+
+    cxx_exports = [
+        PyBindMethod("setInjRate"),
+        PyBindMethod("getNumPacketsSent"),
+    ]
+
     block_offset = Param.Int(6, "block offset in bits")
     num_dest = Param.Int(1, "Number of Destinations")
     memory_size = Param.Int(65536, "memory size")
-    sim_cycles = Param.Int(1000, "Number of simulation cycles")
+    sim_cycles = Param.UInt64(1000, "Number of simulation cycles, \
+                              0 to keep running until something else \
+                              ends the simulation")
     num_packets_max = Param.Int(-1, "Max number of packets to send. \
                         Default is to keep sending till simulation ends")
     single_sender = Param.Int(-1, "Send only from this node. \
@@ -70,6 +70,9 @@ class Consumer
 
     void scheduleEventAbsolute(Tick timeAbs);
 
+    /// Event queue that wakeups of this consumer are scheduled on
+    EventQueue *consumerEventQueue() const { return em->eventQueue(); }
+
   protected:
     void scheduleEvent(Cycles timeDelta);
 
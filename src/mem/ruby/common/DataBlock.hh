@@ -40,9 +40,17 @@ class WriteMask;
 class DataBlock
 {
   public:
+    /**
+     * Blocks of up to this many bytes, i.e., of the default Ruby block
+     * size, are stored in the DataBlock itself. Larger ones are allocated
+     * on the heap.
+     */
+    static const int InlineBytes = 64;
+
     DataBlock()
     {
         alloc();
+        clear();
     }
 
     DataBlock(const DataBlock &cp);
@@ -73,6 +81,7 @@ class DataBlock
     void alloc();
     uint8_t *m_data;
     bool m_alloc;
+    uint8_t m_inline[InlineBytes];
 };
 
 inline void
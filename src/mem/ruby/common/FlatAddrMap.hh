@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_COMMON_FLATADDRMAP_HH__
+#define __MEM_RUBY_COMMON_FLATADDRMAP_HH__
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+/**
+ * An open-addressed hash map from addresses to small values, e.g.,
+ * indices or pointers, used by the Ruby structures to find the entry of
+ * a line. Keys and values are kept side by side in a single flat array,
+ * which is probed linearly, so a lookup usually touches a single cache
+ * line instead of following the bucket list of a std::unordered_map.
+ *
+ * The keys are line addresses, so an all ones key can never be valid and
+ * marks the empty slots. Entries are erased by shifting back the ones
+ * after them, which keeps probe sequences short without tombstones.
+ * Empty slots hold a default constructed value, so values that own
+ * something release it as soon as they are erased.
+ *
+ * Inserting may rehash the table, which invalidates the pointers
+ * returned by find(). Structures that hand out pointers to their entries
+ * keep the entries themselves elsewhere and only map to their index.
+ */
+template <class Value>
+class FlatAddrMap
+{
+  private:
+    static constexpr Addr EmptyKey = ~Addr(0);
+
+    struct Slot
+    {
+        Addr key;
+        Value value;
+    };
+
+    std::vector<Slot> slots;
+    unsigned indexBits;
+    size_t numEntries;
+
+    size_t
+    home(Addr key) const
+    {
+        // Fibonacci hashing, the high bits of the product depend on all
+        // the bits of the key, including the ones above the line offset.
+        return (key * ULL(0x9e3779b97f4a7c15)) >> (64 - indexBits);
+    }
+
+    size_t next(size_t i) const { return (i + 1) & (slots.size() - 1); }
+
+    size_t
+    findSlot(Addr key) const
+    {
+        assert(key != EmptyKey);
+        size_t i = home(key);
+        while (slots[i].key != key && slots[i].key != EmptyKey)
+            i = next(i);
+        return i;
+    }
+
+    void
+    rehash(size_t num_slots)
+    {
+        std::vector<Slot> old_slots(num_slots, Slot{EmptyKey, Value()});
+        old_slots.swap(slots);
+        indexBits = floorLog2(num_slots);
+        for (auto &slot : old_slots) {
+            if (slot.key != EmptyKey)
+                slots[findSlot(slot.key)] = std::move(slot);
+        }
+    }
+
+  public:
+    /**
+     * @param expected_entries Number of entries the map is sized for, it
+     *        grows past it if needed.
+     */
+    explicit FlatAddrMap(size_t expected_entries = 8)
+        : indexBits(0), numEntries(0)
+    {
+        reserve(expected_entries);
+    }
+
+    /** Make room for num_entries entries without rehashing. */
+    void
+    reserve(size_t num_entries)
+    {
+        // Keep the load factor at or below 1/2
+        size_t num_slots = 16;
+        while (num_slots < 2 * num_entries)
+            num_slots *= 2;
+        if (num_slots > slots.size())
+            rehash(num_slots);
+    }
+
+    size_t size() const { return numEntries; }
+    bool empty() const { return numEntries == 0; }
+    bool count(Addr key) const { return find(key) != nullptr; }
+
+    Value *
+    find(Addr key)
+    {
+        Slot &slot = slots[findSlot(key)];
+        return slot.key == key ? &slot.value : nullptr;
+    }
+
+    const Value *
+    find(Addr key) const
+    {
+        const Slot &slot = slots[findSlot(key)];
+        return slot.key == key ? &slot.value : nullptr;
+    }
+
+    /** Find the value of key, inserting a default one if absent. */
+    Value &
+    operator[](Addr key)
+    {
+        size_t i = findSlot(key);
+        if (slots[i].key == key)
+            return slots[i].value;
+
+        if (2 * (numEntries + 1) > slots.size()) {
+            rehash(2 * slots.size());
+            i = findSlot(key);
+        }
+        slots[i].key = key;
+        slots[i].value = Value();
+        numEntries++;
+        return slots[i].value;
+    }
+
+    /** Erase key, returning whether it was present. */
+    bool
+    erase(Addr key)
+    {
+        size_t i = findSlot(key);
+        if (slots[i].key != key)
+            return false;
+
+        // Move back the entries that would not be found anymore once
+        // slot i is empty, i.e., the ones whose home is not in (i, j].
+        size_t j = i;
+        while (true) {
+            j = next(j);
+            if (slots[j].key == EmptyKey)
+                break;
+            size_t h = home(slots[j].key);
+            bool between = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+            if (!between) {
+                slots[i] = std::move(slots[j]);
+                i = j;
+            }
+        }
+        slots[i] = Slot{EmptyKey, Value()};
+        numEntries--;
+        return true;
+    }
+
+    void
+    clear()
+    {
+        for (auto &slot : slots)
+            slot = Slot{EmptyKey, Value()};
+        numEntries = 0;
+    }
+
+    /** Call f(key, value) for every entry, in no particular order. */
+    template <class F>
+    void
+    forEach(F f) const
+    {
+        for (const auto &slot : slots) {
+            if (slot.key != EmptyKey)
+                f(slot.key, slot.value);
+        }
+    }
+};
+
+template <class Value>
+constexpr Addr FlatAddrMap<Value>::EmptyKey;
+
+#endif // __MEM_RUBY_COMMON_FLATADDRMAP_HH__
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "mem/ruby/common/FlatAddrMap.hh"
+
+namespace
+{
+
+const Addr LineBytes = 64;
+
+/** Check that map holds exactly the entries of ref. */
+void
+expectSame(const FlatAddrMap<int> &map,
+           const std::unordered_map<Addr, int> &ref)
+{
+    ASSERT_EQ(map.size(), ref.size());
+    ASSERT_EQ(map.empty(), ref.empty());
+
+    size_t visited = 0;
+    map.forEach([&](Addr key, int value) {
+        auto it = ref.find(key);
+        ASSERT_NE(it, ref.end()) << "unexpected key " << key;
+        EXPECT_EQ(value, it->second);
+        visited++;
+    });
+    EXPECT_EQ(visited, ref.size());
+
+    for (const auto &entry : ref) {
+        const int *value = map.find(entry.first);
+        ASSERT_NE(value, nullptr) << "missing key " << entry.first;
+        EXPECT_EQ(*value, entry.second);
+    }
+}
+
+/**
+ * The slot a key is hashed to in a table of 2^index_bits slots. This
+ * mirrors FlatAddrMap::home(), and is only used to pick keys that
+ * collide.
+ */
+size_t
+home(Addr key, unsigned index_bits)
+{
+    return (key * ULL(0x9e3779b97f4a7c15)) >> (64 - index_bits);
+}
+
+/** Find count line addresses which hash to slot in a 16 slot table. */
+std::vector<Addr>
+keysAt(size_t slot, size_t count)
+{
+    std::vector<Addr> keys;
+    for (Addr key = LineBytes; keys.size() < count; key += LineBytes) {
+        if (home(key, 4) == slot)
+            keys.push_back(key);
+    }
+    return keys;
+}
+
+/** The keys of a map, in slot order. */
+std::vector<Addr>
+slotOrder(const FlatAddrMap<int> &map)
+{
+    std::vector<Addr> keys;
+    map.forEach([&](Addr key, int value) { keys.push_back(key); });
+    return keys;
+}
+
+} // anonymous namespace
+
+/** Nothing is found in an empty map. */
+TEST(FlatAddrMapTest, Empty)
+{
+    FlatAddrMap<int> map;
+
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_EQ(map.find(0x40), nullptr);
+    EXPECT_FALSE(map.count(0x40));
+    EXPECT_FALSE(map.erase(0x40));
+}
+
+/** Inserting, finding and erasing a few entries. */
+TEST(FlatAddrMapTest, InsertFindErase)
+{
+    FlatAddrMap<int> map;
+
+    map[0x40] = 1;
+    map[0x80] = 2;
+    EXPECT_EQ(map.size(), 2);
+    ASSERT_NE(map.find(0x40), nullptr);
+    EXPECT_EQ(*map.find(0x40), 1);
+    EXPECT_TRUE(map.count(0x80));
+
+    // operator[] finds existing entries instead of resetting them.
+    EXPECT_EQ(map[0x80], 2);
+    EXPECT_EQ(map.size(), 2);
+
+    EXPECT_TRUE(map.erase(0x40));
+    EXPECT_FALSE(map.erase(0x40));
+    EXPECT_EQ(map.find(0x40), nullptr);
+    EXPECT_EQ(map.size(), 1);
+
+    // A reinserted key starts from a default value.
+    EXPECT_EQ(map[0x40], 0);
+}
+
+/**
+ * Erasing from a probe run which wraps around the end of the table
+ * moves back the entries after it, including the ones at the start of
+ * the table, and the ones hashed to the start of the table.
+ */
+TEST(FlatAddrMapTest, EraseWrappedRun)
+{
+    std::vector<Addr> at15 = keysAt(15, 4);
+    std::vector<Addr> at0 = keysAt(0, 2);
+
+    // Erase all the entries of the run, starting from each of them.
+    for (size_t first = 0; first < at15.size() + at0.size(); first++) {
+        FlatAddrMap<int> map(8);
+        std::unordered_map<Addr, int> ref;
+        int n = 0;
+        for (Addr key : at15)
+            map[key] = ref[key] = n++;
+        for (Addr key : at0)
+            map[key] = ref[key] = n++;
+
+        // The run starts at the last slot, and wraps around to slots
+        // 0 to 4.
+        std::vector<Addr> order = slotOrder(map);
+        ASSERT_EQ(order.size(), 6);
+        EXPECT_EQ(order.back(), at15[0]);
+        EXPECT_EQ(order[0], at15[1]);
+        EXPECT_EQ(order[3], at0[0]);
+
+        for (size_t i = 0; i < at15.size() + at0.size(); i++) {
+            size_t pos = (first + i) % (at15.size() + at0.size());
+            Addr key = pos < at15.size() ? at15[pos] :
+                at0[pos - at15.size()];
+            ASSERT_TRUE(map.erase(key));
+            ref.erase(key);
+            expectSame(map, ref);
+        }
+    }
+}
+
+/** Growing past the reserved size rehashes, keeping every entry. */
+TEST(FlatAddrMapTest, Rehash)
+{
+    FlatAddrMap<int> map(4);
+    std::unordered_map<Addr, int> ref;
+
+    for (int i = 0; i < 5000; i++) {
+        Addr key = Addr(i) * LineBytes * 3;
+        map[key] = ref[key] = i;
+        if ((i & (i + 1)) == 0)
+            expectSame(map, ref);
+    }
+    expectSame(map, ref);
+
+    // Reserving less than the current size does not lose anything.
+    map.reserve(1);
+    expectSame(map, ref);
+    map.reserve(20000);
+    expectSame(map, ref);
+}
+
+/** Iteration visits the entries left after erasing, once each. */
+TEST(FlatAddrMapTest, IterateAfterErase)
+{
+    FlatAddrMap<int> map;
+    std::unordered_map<Addr, int> ref;
+
+    for (int i = 0; i < 200; i++)
+        map[i * LineBytes] = ref[i * LineBytes] = i;
+    for (int i = 0; i < 200; i += 3) {
+        map.erase(i * LineBytes);
+        ref.erase(i * LineBytes);
+    }
+    expectSame(map, ref);
+
+    map.clear();
+    ref.clear();
+    expectSame(map, ref);
+}
+
+/** Random inserts, erases and finds behave like std::unordered_map. */
+TEST(FlatAddrMapTest, RandomAgainstUnorderedMap)
+{
+    FlatAddrMap<int> map;
+    std::unordered_map<Addr, int> ref;
+    std::mt19937 rng(1);
+    // A small key space, so that keys are often hit again.
+    std::uniform_int_distribution<Addr> lines(0, 1023);
+
+    for (int i = 0; i < 200000; i++) {
+        Addr key = lines(rng) * LineBytes;
+        switch (rng() % 4) {
+          case 0:
+          case 1:
+            map[key] = ref[key] = i;
+            break;
+          case 2:
+            ASSERT_EQ(map.erase(key), ref.erase(key) == 1);
+            break;
+          default: {
+            const int *value = map.find(key);
+            auto it = ref.find(key);
+            if (it == ref.end()) {
+                ASSERT_EQ(value, nullptr);
+            } else {
+                ASSERT_NE(value, nullptr);
+                ASSERT_EQ(*value, it->second);
+            }
+            break;
+          }
+        }
+        ASSERT_EQ(map.size(), ref.size());
+        if (i % 10000 == 0)
+            expectSame(map, ref);
+    }
+    expectSame(map, ref);
+}
+
+/** Erasing and clearing release the values. */
+TEST(FlatAddrMapTest, ReleaseValues)
+{
+    FlatAddrMap<std::shared_ptr<int>> map;
+    std::shared_ptr<int> a = std::make_shared<int>(1);
+    std::shared_ptr<int> b = std::make_shared<int>(2);
+
+    map[0x40] = a;
+    map[0x80] = b;
+    EXPECT_EQ(a.use_count(), 2);
+
+    map.erase(0x40);
+    EXPECT_EQ(a.use_count(), 1);
+
+    map.clear();
+    EXPECT_EQ(b.use_count(), 1);
+}
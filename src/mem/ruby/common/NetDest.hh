@@ -29,35 +29,81 @@
 #ifndef __MEM_RUBY_COMMON_NETDEST_HH__
 #define __MEM_RUBY_COMMON_NETDEST_HH__
 
+#include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
-#include "mem/ruby/common/Set.hh"
+#include "base/bitfield.hh"
+#include "base/logging.hh"
 #include "mem/ruby/common/MachineID.hh"
+#include "mem/ruby/common/Set.hh"
 
 // NetDest specifies the network destination of a Message
+//
+// The destinations are kept in a fixed size bit vector held inline, with
+// room for NUMBER_BITS_PER_SET machines of every machine type, so that
+// copying a NetDest along with its message does not allocate, set
+// operations are a few word operations, and the destinations are walked
+// with count trailing zeros rather than by testing every bit.
 class NetDest
 {
   public:
     // Constructors
     // creates and empty set
-    NetDest();
-    explicit NetDest(int bit_size);
+    NetDest() { clear(); }
 
-    NetDest& operator=(const Set& obj);
+    void
+    add(MachineID newElement)
+    {
+        fatal_if(newElement.num >= NUMBER_BITS_PER_SET,
+                 "Number of bits(%d) < size specified(%d). "
+                 "Increase the number of bits and recompile.\n",
+                 NUMBER_BITS_PER_SET, newElement.num + 1);
+        word(newElement) |= mask(newElement.num);
+    }
 
-    ~NetDest()
-    { }
+    void
+    addNetDest(const NetDest& netDest)
+    {
+        for (int i = 0; i < NumWords; i++)
+            m_bits[i] |= netDest.m_bits[i];
+    }
 
-    void add(MachineID newElement);
-    void addNetDest(const NetDest& netDest);
     void setNetDest(MachineType machine, const Set& set);
-    void remove(MachineID oldElement);
-    void removeNetDest(const NetDest& netDest);
-    void clear();
+
+    void
+    remove(MachineID oldElement)
+    {
+        word(oldElement) &= ~mask(oldElement.num);
+    }
+
+    void
+    removeNetDest(const NetDest& netDest)
+    {
+        for (int i = 0; i < NumWords; i++)
+            m_bits[i] &= ~netDest.m_bits[i];
+    }
+
+    void
+    clear()
+    {
+        for (int i = 0; i < NumWords; i++)
+            m_bits[i] = 0;
+    }
+
     void broadcast();
     void broadcast(MachineType machine);
-    int count() const;
+
+    int
+    count() const
+    {
+        int counter = 0;
+        for (int i = 0; i < NumWords; i++)
+            counter += popCount(m_bits[i]);
+        return counter;
+    }
+
     bool isEqual(const NetDest& netDest) const;
 
     // return the logical OR of this netDest and orNetDest
@@ -67,16 +113,41 @@ class NetDest
     NetDest AND(const NetDest& andNetDest) const;
 
     // Returns true if the intersection of the two netDests is non-empty
-    bool intersectionIsNotEmpty(const NetDest& other_netDest) const;
+    bool
+    intersectionIsNotEmpty(const NetDest& other_netDest) const
+    {
+        Word any = 0;
+        for (int i = 0; i < NumWords; i++)
+            any |= m_bits[i] & other_netDest.m_bits[i];
+        return any != 0;
+    }
 
     // Returns true if the intersection of the two netDests is empty
-    bool intersectionIsEmpty(const NetDest& other_netDest) const;
+    bool
+    intersectionIsEmpty(const NetDest& other_netDest) const
+    {
+        return !intersectionIsNotEmpty(other_netDest);
+    }
 
     bool isSuperset(const NetDest& test) const;
     bool isSubset(const NetDest& test) const { return test.isSuperset(*this); }
-    bool isElement(MachineID element) const;
+
+    bool
+    isElement(MachineID element) const
+    {
+        return (word(element) & mask(element.num)) != 0;
+    }
+
     bool isBroadcast() const;
-    bool isEmpty() const;
+
+    bool
+    isEmpty() const
+    {
+        Word any = 0;
+        for (int i = 0; i < NumWords; i++)
+            any |= m_bits[i];
+        return any == 0;
+    }
 
     // For Princeton Network
     std::vector<NodeID> getAllDest();
@@ -84,28 +155,58 @@ class NetDest
     MachineID smallestElement() const;
     MachineID smallestElement(MachineType machine) const;
 
-    void resize();
-    int getSize() const { return m_bits.size(); }
+    int getSize() const { return MachineType_NUM; }
 
     // get element for a index
-    NodeID elementAt(MachineID index);
+    NodeID elementAt(MachineID index) { return isElement(index); }
 
     void print(std::ostream& out) const;
 
   private:
-    // returns a value >= MachineType_base_level("this machine")
-    // and < MachineType_base_level("next highest machine")
-    int
-    vecIndex(MachineID m) const
+    typedef uint64_t Word;
+    static const int BitsPerWord = 64;
+    static const int WordsPerType =
+        (NUMBER_BITS_PER_SET + BitsPerWord - 1) / BitsPerWord;
+    static const int NumWords = MachineType_NUM * WordsPerType;
+
+    // the words of a machine type start at its base level, which is its
+    // position in the MachineType enum
+    static int
+    wordIndex(MachineType type, NodeID num)
+    {
+        return type * WordsPerType + num / BitsPerWord;
+    }
+
+    static Word mask(NodeID num) { return Word(1) << (num % BitsPerWord); }
+
+    Word &
+    word(MachineID m)
     {
-        int vec_index = MachineType_base_level(m.type);
-        assert(vec_index < m_bits.size());
-        return vec_index;
+        assert(m.type < MachineType_NUM && m.num < NUMBER_BITS_PER_SET);
+        return m_bits[wordIndex(m.type, m.num)];
     }
 
-    NodeID bitIndex(NodeID index) const { return index; }
+    const Word &
+    word(MachineID m) const
+    {
+        assert(m.type < MachineType_NUM && m.num < NUMBER_BITS_PER_SET);
+        return m_bits[wordIndex(m.type, m.num)];
+    }
+
+    // Calls f(type, num) for every destination, in increasing order
+    template <class F>
+    void
+    forEachElement(F f) const
+    {
+        for (int i = 0; i < NumWords; i++) {
+            MachineType type = MachineType(i / WordsPerType);
+            NodeID base = (i % WordsPerType) * BitsPerWord;
+            for (Word w = m_bits[i]; w != 0; w &= w - 1)
+                f(type, base + ctz64(w));
+        }
+    }
 
-    std::vector<Set> m_bits;  // a vector of bit vectors - i.e. Sets
+    Word m_bits[NumWords];
 };
 
 inline std::ostream&
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "mem/ruby/common/NetDest.hh"
+
+/*
+ * The MachineType functions are generated along with the controllers of
+ * the protocol, which count the machines of every type. They are not part
+ * of this test, so give every type a count here instead: all
+ * NUMBER_BITS_PER_SET machines, none, one, or a few.
+ */
+MachineType &
+operator++(MachineType &e)
+{
+    assert(e < MachineType_NUM);
+    return e = MachineType(e + 1);
+}
+
+int
+MachineType_base_count(const MachineType &obj)
+{
+    switch (obj % 4) {
+      case 0:
+        return NUMBER_BITS_PER_SET;
+      case 1:
+        return 0;
+      case 2:
+        return 1;
+      default:
+        return std::min(NUMBER_BITS_PER_SET, 5);
+    }
+}
+
+int
+MachineType_base_level(const MachineType &obj)
+{
+    return obj;
+}
+
+int
+MachineType_base_number(const MachineType &obj)
+{
+    int number = 0;
+    for (MachineType type = MachineType_FIRST; type < obj; ++type)
+        number += MachineType_base_count(type);
+    return number;
+}
+
+namespace
+{
+
+typedef std::set<std::pair<int, NodeID>> Reference;
+
+/**
+ * Machine numbers next to the word boundaries of the bit vector, and at
+ * both ends of the range of a type.
+ */
+std::vector<NodeID>
+boundaryNodes()
+{
+    std::vector<NodeID> nodes;
+    for (NodeID num : { 0, 1, 62, 63, 64, 65, 127, 128 }) {
+        if (num < NUMBER_BITS_PER_SET)
+            nodes.push_back(num);
+    }
+    if (nodes.back() != NUMBER_BITS_PER_SET - 1)
+        nodes.push_back(NUMBER_BITS_PER_SET - 1);
+    return nodes;
+}
+
+MachineID
+machine(int type, NodeID num)
+{
+    MachineID mach = {MachineType(type), num};
+    return mach;
+}
+
+/** Check that dest holds exactly the machines of ref. */
+void
+expectSame(const NetDest &dest, const Reference &ref)
+{
+    ASSERT_EQ(dest.count(), ref.size());
+    ASSERT_EQ(dest.isEmpty(), ref.empty());
+    for (int type = MachineType_FIRST; type < MachineType_NUM; type++) {
+        for (NodeID num : boundaryNodes()) {
+            ASSERT_EQ(dest.isElement(machine(type, num)),
+                      ref.count(std::make_pair(type, num)) == 1)
+                << "type " << type << " num " << num;
+        }
+    }
+    for (const auto &m : ref)
+        ASSERT_TRUE(dest.isElement(machine(m.first, m.second)));
+    if (!ref.empty()) {
+        MachineID smallest = dest.smallestElement();
+        EXPECT_EQ(int(smallest.type), ref.begin()->first);
+        EXPECT_EQ(smallest.num, ref.begin()->second);
+    }
+}
+
+} // anonymous namespace
+
+/** A new NetDest is empty. */
+TEST(NetDestTest, Empty)
+{
+    NetDest dest;
+
+    EXPECT_TRUE(dest.isEmpty());
+    EXPECT_EQ(dest.count(), 0);
+    expectSame(dest, Reference());
+}
+
+/**
+ * Adding and removing single machines around the word boundaries, of
+ * every type, only touches their own bit.
+ */
+TEST(NetDestTest, AddRemoveBoundaries)
+{
+    for (int type = MachineType_FIRST; type < MachineType_NUM; type++) {
+        for (NodeID num : boundaryNodes()) {
+            NetDest dest;
+            Reference ref;
+
+            dest.add(machine(type, num));
+            ref.insert(std::make_pair(type, num));
+            expectSame(dest, ref);
+            EXPECT_EQ(dest.smallestElement(MachineType(type)).num, num);
+
+            // Adding twice does not count twice.
+            dest.add(machine(type, num));
+            expectSame(dest, ref);
+
+            dest.remove(machine(type, num));
+            ref.clear();
+            expectSame(dest, ref);
+        }
+    }
+}
+
+/** Every machine of every type can be held at the same time. */
+TEST(NetDestTest, AllMachines)
+{
+    NetDest dest;
+    Reference ref;
+
+    for (int type = MachineType_FIRST; type < MachineType_NUM; type++) {
+        for (NodeID num = 0; num < NUMBER_BITS_PER_SET; num++) {
+            dest.add(machine(type, num));
+            ref.insert(std::make_pair(type, num));
+        }
+    }
+    expectSame(dest, ref);
+
+    for (int type = MachineType_FIRST; type < MachineType_NUM; type++) {
+        for (NodeID num = 0; num < NUMBER_BITS_PER_SET; num += 2) {
+            dest.remove(machine(type, num));
+            ref.erase(std::make_pair(type, num));
+        }
+    }
+    expectSame(dest, ref);
+}
+
+/** Broadcasting to a type sets the range of machines of that type. */
+TEST(NetDestTest, BroadcastType)
+{
+    for (int type = MachineType_FIRST; type < MachineType_NUM; type++) {
+        NetDest dest;
+        Reference ref;
+
+        dest.broadcast(MachineType(type));
+        NodeID count = MachineType_base_count(MachineType(type));
+        for (NodeID num = 0; num < count; num++) {
+            ref.insert(std::make_pair(type, num));
+        }
+        expectSame(dest, ref);
+        EXPECT_EQ(dest.isBroadcast(), MachineType_NUM == 1);
+    }
+}
+
+/**
+ * Broadcasting to all types is a broadcast, and the destinations are
+ * listed in order of their global machine number.
+ */
+TEST(NetDestTest, Broadcast)
+{
+    NetDest dest;
+    dest.broadcast();
+    EXPECT_TRUE(dest.isBroadcast());
+
+    std::vector<NodeID> expected;
+    NodeID total = MachineType_base_number(MachineType_NUM);
+    for (NodeID num = 0; num < total; num++)
+        expected.push_back(num);
+    EXPECT_EQ(dest.getAllDest(), expected);
+    EXPECT_EQ(dest.count(), total);
+
+    // Taking away any machine is not a broadcast anymore.
+    dest.remove(dest.smallestElement());
+    EXPECT_FALSE(dest.isBroadcast());
+}
+
+/** setNetDest replaces the machines of one type by those of a Set. */
+TEST(NetDestTest, SetNetDest)
+{
+    MachineType type = MachineType_FIRST;
+    NetDest dest;
+    dest.add(machine(type, 0));
+    dest.add(machine(type, NUMBER_BITS_PER_SET - 1));
+    if (MachineType_NUM > 1)
+        dest.add(machine(type + 1, 0));
+
+    Set set(NUMBER_BITS_PER_SET);
+    Reference ref;
+    for (NodeID num : boundaryNodes()) {
+        if (num % 2 == 1) {
+            set.add(num);
+            ref.insert(std::make_pair(type, num));
+        }
+    }
+    if (MachineType_NUM > 1)
+        ref.insert(std::make_pair(type + 1, 0));
+
+    dest.setNetDest(type, set);
+    expectSame(dest, ref);
+}
+
+/**
+ * Random sets combined with the set operations behave like the same
+ * operations on std::set.
+ */
+TEST(NetDestTest, RandomSetOperations)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> types(MachineType_FIRST,
+                                             MachineType_NUM - 1);
+    std::vector<NodeID> boundary = boundaryNodes();
+
+    auto random_machine = [&]() {
+        int type = types(rng);
+        NodeID num = rng() % 2 ? boundary[rng() % boundary.size()] :
+            NodeID(rng() % NUMBER_BITS_PER_SET);
+        return std::make_pair(type, num);
+    };
+
+    auto random_dest = [&](NetDest &dest, Reference &ref) {
+        int n = rng() % 8;
+        for (int i = 0; i < n; i++) {
+            auto m = random_machine();
+            dest.add(machine(m.first, m.second));
+            ref.insert(m);
+        }
+    };
+
+    for (int i = 0; i < 5000; i++) {
+        NetDest a, b;
+        Reference ref_a, ref_b;
+        random_dest(a, ref_a);
+        random_dest(b, ref_b);
+        // Make b a subset of a now and then.
+        if (i % 4 == 0) {
+            a.addNetDest(b);
+            ref_a.insert(ref_b.begin(), ref_b.end());
+        }
+        expectSame(a, ref_a);
+        expectSame(b, ref_b);
+
+        Reference ref_or, ref_and, ref_minus;
+        std::set_union(ref_a.begin(), ref_a.end(), ref_b.begin(),
+                       ref_b.end(), std::inserter(ref_or, ref_or.end()));
+        std::set_intersection(ref_a.begin(), ref_a.end(), ref_b.begin(),
+                              ref_b.end(),
+                              std::inserter(ref_and, ref_and.end()));
+        std::set_difference(ref_a.begin(), ref_a.end(), ref_b.begin(),
+                            ref_b.end(),
+                            std::inserter(ref_minus, ref_minus.end()));
+
+        expectSame(a.OR(b), ref_or);
+        expectSame(a.AND(b), ref_and);
+        EXPECT_EQ(a.intersectionIsNotEmpty(b), !ref_and.empty());
+        EXPECT_EQ(a.intersectionIsEmpty(b), ref_and.empty());
+
+        bool superset = std::includes(ref_a.begin(), ref_a.end(),
+                                      ref_b.begin(), ref_b.end());
+        EXPECT_EQ(a.isSuperset(b), superset);
+        EXPECT_EQ(b.isSubset(a), superset);
+        EXPECT_EQ(a.isEqual(b), ref_a == ref_b);
+
+        NetDest minus = a;
+        minus.removeNetDest(b);
+        expectSame(minus, ref_minus);
+
+        NetDest both = a;
+        both.addNetDest(b);
+        expectSame(both, ref_or);
+        EXPECT_TRUE(both.isEqual(a.OR(b)));
+    }
+}
@@ -41,7 +41,7 @@ using namespace std;
 using m5::stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params *p)
-    : SimObject(p), m_stall_map_size(0),
+    : SimObject(p),
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p->ordered),
@@ -54,7 +54,6 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_msgs_this_cycle = 0;
     m_priority_rank = 0;
 
-    m_stall_msg_map.clear();
     m_input_link_id = 0;
     m_vnet_id = 0;
 
@@ -105,7 +104,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     }
 
     // now compare the new size with our max size
-    if (current_size + m_stall_map_size + n <= m_max_size) {
+    if (current_size + m_stall_msg_map.size() + n <= m_max_size) {
         return true;
     } else {
         DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
@@ -294,22 +293,18 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::scheduleUnstalled(size_t num_unstalled, Tick schdTick)
 {
-    while (!lt.empty()) {
-        MsgPtr m = lt.front();
-        assert(m->getLastEnqueueTime() <= schdTick);
-
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+    DPRINTF(RubyQueue, "Requeue arrival_time: %lld, %d messages\n",
+            schdTick, num_unstalled);
 
+    //
+    // Make sure the consumer is scheduled for the current cycle so that
+    // the previously stalled messages will be observed before any younger
+    // messages that may arrive this cycle
+    //
+    if (num_unstalled > 0) {
         m_consumer->scheduleEventAbsolute(schdTick);
-
-        DPRINTF(RubyQueue, "Requeue arrival_time: %lld, Message: %s\n",
-            schdTick, *(m.get()));
-
-        lt.pop_front();
     }
 }
 
@@ -317,18 +312,13 @@ void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
-    // scheduled for the current cycle so that the previously stalled messages
-    // will be observed before any younger messages that may arrive this cycle
+    // prio heap.
     //
-    m_stall_map_size -= m_stall_msg_map[addr].size();
-    assert(m_stall_map_size >= 0);
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    size_t num_unstalled = m_stall_msg_map.unstall(addr, m_prio_heap);
+    scheduleUnstalled(num_unstalled, current_time);
 }
 
 void
@@ -337,18 +327,10 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
     DPRINTF(RubyQueue, "ReanalyzeAllMessages\n");
 
     //
-    // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
-    // scheduled for the current cycle so that the previously stalled messages
-    // will be observed before any younger messages that may arrive this cycle.
+    // Put all stalled messages back on the prio heap.
     //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end(); ++map_iter) {
-        m_stall_map_size -= map_iter->second.size();
-        assert(m_stall_map_size >= 0);
-        reanalyzeList(map_iter->second, current_time);
-    }
-    m_stall_msg_map.clear();
+    size_t num_unstalled = m_stall_msg_map.unstallAll(m_prio_heap);
+    scheduleUnstalled(num_unstalled, current_time);
 }
 
 void
@@ -368,8 +350,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
-    m_stall_map_size++;
+    m_stall_msg_map.stall(addr, std::move(message));
     m_stall_count++;
 }
 
@@ -444,19 +425,11 @@ MessageBuffer::functionalWrite(Packet *pkt)
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalWrite(pkt)) {
-                num_functional_writes++;
-            }
+    m_stall_msg_map.forEach([&](Message *msg) {
+        if (msg->functionalWrite(pkt)) {
+            num_functional_writes++;
         }
-    }
+    });
 
     return num_functional_writes;
 }
@@ -47,6 +47,7 @@
 #include "mem/port.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/MessageStallMap.hh"
 #include "mem/ruby/network/dummy_port.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/MessageBuffer.hh"
@@ -110,8 +111,8 @@ class MessageBuffer : public SimObject
 
     void recycle(Tick current_time, Tick recycle_latency);
     bool isEmpty() const { return m_prio_heap.size() == 0; }
-    bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
-    unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
+    bool isStallMapEmpty() { return m_stall_msg_map.numLines() == 0; }
+    unsigned int getStallMapSize() { return m_stall_msg_map.numLines(); }
 
     unsigned int getSize(Tick curTime);
 
@@ -137,7 +138,7 @@ class MessageBuffer : public SimObject
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    void scheduleUnstalled(size_t num_unstalled, Tick schdTick);
 
   private:
     // Data Members (m_ prefix)
@@ -147,32 +148,21 @@ class MessageBuffer : public SimObject
 
     std::function<void()> m_dequeue_callback;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
-
     /**
-     * A map from line addresses to lists of stalled messages for that line.
+     * A map from line addresses to queues of stalled messages for that line.
      * If this buffer allows the receiver to stall messages, on a stall
      * request, the stalled message is removed from the m_prio_heap and placed
      * in the m_stall_msg_map. Messages are held there until the receiver
      * requests they be reanalyzed, at which point they are moved back to
      * m_prio_heap.
      *
-     * NOTE: The stall map holds messages in the order in which they were
-     * initially received, and when a line is unblocked, the messages are
-     * moved back to the m_prio_heap in the same order. This prevents starving
-     * older requests with younger ones.
-     */
-    StallMsgMapType m_stall_msg_map;
-
-    /**
-     * Current size of the stall map.
-     * Track the number of messages held in stall map lists. This is used to
-     * ensure that if the buffer is finite-sized, it blocks further requests
-     * when the m_prio_heap and m_stall_msg_map contain m_max_size messages.
+     * NOTE: Stalled messages keep their arrival time and message counter,
+     * which order them on the m_prio_heap, so when a line is unblocked they
+     * are dequeued in the order in which they were initially received. This
+     * prevents starving older requests with younger ones, and makes the
+     * order in which the lines are visited irrelevant.
      */
-    int m_stall_map_size;
+    MessageStallMap m_stall_msg_map;
 
     /**
      * The maximum capacity. For finite-sized buffers, m_max_size stores a
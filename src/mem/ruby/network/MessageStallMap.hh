@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_MESSAGESTALLMAP_HH__
+#define __MEM_RUBY_NETWORK_MESSAGESTALLMAP_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+#include "mem/ruby/common/FlatAddrMap.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/**
+ * The messages a MessageBuffer holds back on stall requests, keyed by
+ * the line they wait for. The messages of a line are queued oldest
+ * first, linked through the messages themselves so that stalling a
+ * message does not allocate.
+ *
+ * Unstalling moves the messages back to the end of the priority heap of
+ * the buffer and restores the heap once for the whole batch. Stalled
+ * messages keep their arrival time and message counter, which totally
+ * order the heap, so they are dequeued in the order in which they were
+ * initially received, whatever order the lines are visited in.
+ */
+class MessageStallMap
+{
+  private:
+    struct Queue
+    {
+        MsgPtr head;
+        Message *tail;
+        unsigned size;
+
+        Queue() : tail(nullptr), size(0) {}
+    };
+
+    FlatAddrMap<Queue> queues;
+    size_t numMessages;
+
+    /** Unlink the messages of a queue and append them to heap. */
+    void
+    unlink(const Queue &queue, std::vector<MsgPtr> &heap)
+    {
+        MsgPtr m = queue.head;
+        while (m) {
+            MsgPtr next = std::move(m->m_stall_next);
+            heap.push_back(std::move(m));
+            m = std::move(next);
+        }
+        assert(numMessages >= queue.size);
+        numMessages -= queue.size;
+    }
+
+    /**
+     * Put the last num_unstalled messages of heap in place. Sifting each
+     * of them up costs O(log n), while rebuilding the heap costs O(n), so
+     * large batches, e.g., when a contended line unblocks or all the
+     * messages are reanalyzed, are put in place with a single heapify.
+     */
+    static void
+    requeue(std::vector<MsgPtr> &heap, size_t num_unstalled)
+    {
+        size_t size = heap.size();
+        if (num_unstalled * floorLog2(size + 1) > size) {
+            std::make_heap(heap.begin(), heap.end(), std::greater<MsgPtr>());
+        } else {
+            for (size_t i = size - num_unstalled; i < size; i++) {
+                std::push_heap(heap.begin(), heap.begin() + i + 1,
+                               std::greater<MsgPtr>());
+            }
+        }
+    }
+
+  public:
+    MessageStallMap() : numMessages(0) {}
+
+    /** Number of stalled messages. */
+    size_t size() const { return numMessages; }
+    /** Number of lines with stalled messages. */
+    size_t numLines() const { return queues.size(); }
+    bool empty() const { return numMessages == 0; }
+
+    /** Stall a message, which was just taken off the heap, on a line. */
+    void
+    stall(Addr addr, MsgPtr message)
+    {
+        Queue &queue = queues[addr];
+        Message *msg = message.get();
+        assert(!msg->m_stall_next);
+        if (queue.tail) {
+            queue.tail->m_stall_next = std::move(message);
+        } else {
+            queue.head = std::move(message);
+        }
+        queue.tail = msg;
+        queue.size++;
+        numMessages++;
+    }
+
+    /**
+     * Move the messages stalled on a line back to a heap ordered by
+     * std::greater<MsgPtr>.
+     * @return The number of messages moved.
+     */
+    size_t
+    unstall(Addr addr, std::vector<MsgPtr> &heap)
+    {
+        Queue *queue = queues.find(addr);
+        assert(queue);
+
+        size_t num_unstalled = queue->size;
+        unlink(*queue, heap);
+        queues.erase(addr);
+        requeue(heap, num_unstalled);
+        return num_unstalled;
+    }
+
+    /**
+     * Move all the stalled messages back to a heap ordered by
+     * std::greater<MsgPtr>.
+     * @return The number of messages moved.
+     */
+    size_t
+    unstallAll(std::vector<MsgPtr> &heap)
+    {
+        size_t num_unstalled = numMessages;
+        queues.forEach([&](Addr addr, const Queue &queue) {
+            unlink(queue, heap);
+        });
+        queues.clear();
+        requeue(heap, num_unstalled);
+        return num_unstalled;
+    }
+
+    /** Call f(msg) for every stalled message, in no particular order. */
+    template <class F>
+    void
+    forEach(F f) const
+    {
+        queues.forEach([&](Addr addr, const Queue &queue) {
+            for (Message *msg = queue.head.get(); msg;
+                 msg = msg->m_stall_next.get()) {
+                f(msg);
+            }
+        });
+    }
+};
+
+#endif // __MEM_RUBY_NETWORK_MESSAGESTALLMAP_HH__
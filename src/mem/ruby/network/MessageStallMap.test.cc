@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/network/MessageStallMap.hh"
+
+namespace
+{
+
+const Addr LineBytes = 64;
+
+/** A message which only carries the keys of the heap order. */
+class TestMessage : public Message
+{
+  public:
+    static int live;
+
+    TestMessage(Tick arrival, uint64_t counter) : Message(arrival)
+    {
+        setLastEnqueueTime(arrival);
+        setMsgCounter(counter);
+        live++;
+    }
+
+    ~TestMessage() { live--; }
+
+    MsgPtr clone() const { return new TestMessage(*this); }
+    void print(std::ostream &out) const { out << getMsgCounter(); }
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+
+  private:
+    TestMessage(const TestMessage &other) : Message(other) { live++; }
+};
+
+int TestMessage::live = 0;
+
+typedef std::vector<MsgPtr> Heap;
+
+void
+push(Heap &heap, MsgPtr msg)
+{
+    heap.push_back(msg);
+    std::push_heap(heap.begin(), heap.end(), std::greater<MsgPtr>());
+}
+
+MsgPtr
+pop(Heap &heap)
+{
+    MsgPtr msg = heap.front();
+    std::pop_heap(heap.begin(), heap.end(), std::greater<MsgPtr>());
+    heap.pop_back();
+    return msg;
+}
+
+/**
+ * The stall map of MessageBuffer before it was indexed: per line lists
+ * in a std::map, whose messages are pushed back onto the heap one by
+ * one, oldest first.
+ */
+class ReferenceBuffer
+{
+  public:
+    Heap heap;
+    std::map<Addr, std::list<MsgPtr>> stalled;
+
+    void
+    stall(Addr addr)
+    {
+        stalled[addr].push_back(pop(heap));
+    }
+
+    size_t
+    unstall(Addr addr)
+    {
+        auto it = stalled.find(addr);
+        size_t num_unstalled = it->second.size();
+        for (auto &msg : it->second)
+            push(heap, msg);
+        stalled.erase(it);
+        return num_unstalled;
+    }
+
+    size_t
+    unstallAll()
+    {
+        size_t num_unstalled = 0;
+        for (auto &line : stalled) {
+            num_unstalled += line.second.size();
+            for (auto &msg : line.second)
+                push(heap, msg);
+        }
+        stalled.clear();
+        return num_unstalled;
+    }
+
+    size_t
+    numStalled() const
+    {
+        size_t n = 0;
+        for (auto &line : stalled)
+            n += line.second.size();
+        return n;
+    }
+};
+
+/** The counters of the messages of a heap, in dequeue order. */
+std::vector<uint64_t>
+drain(Heap heap)
+{
+    std::vector<uint64_t> order;
+    while (!heap.empty())
+        order.push_back(pop(heap)->getMsgCounter());
+    return order;
+}
+
+} // anonymous namespace
+
+/** Messages stalled on a line come back oldest first. */
+TEST(MessageStallMapTest, UnstallLine)
+{
+    MessageStallMap map;
+    Heap heap;
+
+    for (uint64_t c = 1; c <= 6; c++)
+        push(heap, new TestMessage(10, c));
+
+    // Stall 1, 2 and 4 on one line, 3 on another.
+    map.stall(0x40, pop(heap));
+    map.stall(0x40, pop(heap));
+    map.stall(0x80, pop(heap));
+    map.stall(0x40, pop(heap));
+    EXPECT_EQ(map.size(), 4);
+    EXPECT_EQ(map.numLines(), 2);
+    EXPECT_EQ(heap.size(), 2);
+
+    // A younger message arrives before the line unblocks.
+    push(heap, new TestMessage(5, 7));
+
+    EXPECT_EQ(map.unstall(0x40, heap), 3);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.numLines(), 1);
+    EXPECT_EQ(drain(heap), std::vector<uint64_t>({ 7, 1, 2, 4, 5, 6 }));
+
+    EXPECT_EQ(map.unstall(0x80, heap), 1);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.numLines(), 0);
+}
+
+/** Unstalling every line merges them back in arrival order. */
+TEST(MessageStallMapTest, UnstallAll)
+{
+    MessageStallMap map;
+    Heap heap;
+
+    for (uint64_t c = 1; c <= 64; c++)
+        push(heap, new TestMessage(10 + c / 4, c));
+    // Spread the older half over many lines, so that the requeue takes
+    // the make_heap path.
+    for (int i = 0; i < 32; i++)
+        map.stall((i % 7) * LineBytes, pop(heap));
+
+    EXPECT_EQ(map.unstallAll(heap), 32);
+    EXPECT_TRUE(map.empty());
+
+    std::vector<uint64_t> expected;
+    for (uint64_t c = 1; c <= 64; c++)
+        expected.push_back(c);
+    EXPECT_EQ(drain(heap), expected);
+}
+
+/** The messages are released once they leave the map and the heap. */
+TEST(MessageStallMapTest, Release)
+{
+    {
+        MessageStallMap map;
+        Heap heap;
+        for (uint64_t c = 1; c <= 8; c++)
+            push(heap, new TestMessage(1, c));
+        for (int i = 0; i < 8; i++)
+            map.stall((i % 3) * LineBytes, pop(heap));
+        EXPECT_EQ(TestMessage::live, 8);
+
+        map.unstall(0, heap);
+        while (!heap.empty())
+            pop(heap);
+        EXPECT_EQ(TestMessage::live, 5);
+    }
+    EXPECT_EQ(TestMessage::live, 0);
+}
+
+/** forEach visits every stalled message once. */
+TEST(MessageStallMapTest, ForEach)
+{
+    MessageStallMap map;
+    Heap heap;
+
+    for (uint64_t c = 1; c <= 10; c++)
+        push(heap, new TestMessage(1, c));
+    for (int i = 0; i < 10; i++)
+        map.stall((i % 4) * LineBytes, pop(heap));
+
+    std::vector<uint64_t> seen;
+    map.forEach([&](Message *msg) { seen.push_back(msg->getMsgCounter()); });
+    std::sort(seen.begin(), seen.end());
+
+    std::vector<uint64_t> expected;
+    for (uint64_t c = 1; c <= 10; c++)
+        expected.push_back(c);
+    EXPECT_EQ(seen, expected);
+}
+
+/**
+ * A random stream of enqueues, stalls, dequeues and reanalyzes of single
+ * lines or of all of them dequeues the messages in the same order as the
+ * reference buffer. The batches vary in size, so both the sift up and
+ * the make_heap requeue are taken.
+ */
+TEST(MessageStallMapTest, RandomAgainstReference)
+{
+    MessageStallMap map;
+    Heap heap;
+    ReferenceBuffer ref;
+    std::mt19937 rng(1);
+    uint64_t counter = 0;
+    Tick now = 0;
+
+    for (int i = 0; i < 200000; i++) {
+        now++;
+        unsigned op = rng() % 32;
+        // Few lines, so that their queues grow long.
+        Addr addr = (rng() % 8) * LineBytes;
+
+        if (op < 12) {
+            // Enqueue the same message in both buffers, keeping them
+            // about as full as a finite MessageBuffer.
+            if (heap.size() + map.size() >= 128)
+                continue;
+            Tick arrival = now + rng() % 5;
+            counter++;
+            push(heap, new TestMessage(arrival, counter));
+            push(ref.heap, new TestMessage(arrival, counter));
+        } else if (op < 22) {
+            // Stall the ready head of the queue.
+            if (heap.empty() || heap.front()->getLastEnqueueTime() > now)
+                continue;
+            map.stall(addr, pop(heap));
+            ref.stall(addr);
+        } else if (op < 26) {
+            // Dequeue the ready head of the queue.
+            if (heap.empty() || heap.front()->getLastEnqueueTime() > now)
+                continue;
+            ASSERT_EQ(pop(heap)->getMsgCounter(),
+                      pop(ref.heap)->getMsgCounter());
+        } else if (op < 31) {
+            if (ref.stalled.count(addr) == 0)
+                continue;
+            ASSERT_EQ(map.unstall(addr, heap), ref.unstall(addr));
+        } else {
+            ASSERT_EQ(map.unstallAll(heap), ref.unstallAll());
+        }
+
+        ASSERT_EQ(heap.size(), ref.heap.size());
+        ASSERT_EQ(map.size(), ref.numStalled());
+        ASSERT_EQ(map.numLines(), ref.stalled.size());
+        ASSERT_TRUE(std::is_heap(heap.begin(), heap.end(),
+                                 std::greater<MsgPtr>()));
+    }
+
+    map.unstallAll(heap);
+    ref.unstallAll();
+    ASSERT_EQ(drain(heap), drain(ref.heap));
+}
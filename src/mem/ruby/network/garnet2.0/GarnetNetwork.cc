@@ -57,7 +57,7 @@ using m5::stl_helpers::deletePointers;
  */
 
 GarnetNetwork::GarnetNetwork(const Params *p)
-    : Network(p)
+    : Network(p), m_sweep_packets_received(0), m_sweep_packet_latency(0)
 {
     m_num_rows = p->num_rows;
     m_ni_flit_size = p->ni_flit_size;
@@ -108,20 +108,38 @@ class GarnetNetwork : public Network
 
     // increment counters
     void increment_injected_packets(int vnet) { m_packets_injected[vnet]++; }
-    void increment_received_packets(int vnet) { m_packets_received[vnet]++; }
+
+    void
+    increment_received_packets(int vnet)
+    {
+        m_packets_received[vnet]++;
+        m_sweep_packets_received++;
+    }
 
     void
     increment_packet_network_latency(Cycles latency, int vnet)
     {
         m_packet_network_latency[vnet] += latency;
+        m_sweep_packet_latency += latency;
     }
 
     void
     increment_packet_queueing_latency(Cycles latency, int vnet)
     {
         m_packet_queueing_latency[vnet] += latency;
+        m_sweep_packet_latency += latency;
     }
 
+    /**
+     * Running totals of received packets and of their network plus
+     * queueing latency in cycles. Unlike the statistics these are never
+     * reset, so that a driver script (see garnet_synth_traffic.py) can
+     * take differences across stats resets and check when the network
+     * has drained.
+     */
+    uint64_t getPacketsReceived() const { return m_sweep_packets_received; }
+    uint64_t getPacketLatency() const { return m_sweep_packet_latency; }
+
     void increment_injected_flits(int vnet) { m_flits_injected[vnet]++; }
     void increment_received_flits(int vnet) { m_flits_received[vnet]++; }
 
@@ -186,6 +204,10 @@ class GarnetNetwork : public Network
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
+    // Sweep counters, see getPacketsReceived()
+    uint64_t m_sweep_packets_received;
+    uint64_t m_sweep_packet_latency;
+
   private:
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
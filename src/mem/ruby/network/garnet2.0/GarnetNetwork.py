@@ -28,6 +28,7 @@
 # Author: Tushar Krishna
 #
 
+from m5.SimObject import *
 from m5.params import *
 from m5.proxy import *
 from m5.objects.Network import RubyNetwork
@@ -37,6 +38,12 @@ from m5.objects.ClockedObject import ClockedObject
 class GarnetNetwork(RubyNetwork):
     type = 'GarnetNetwork'
     cxx_header = "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+
+    cxx_exports = [
+        PyBindMethod("getPacketsReceived"),
+        PyBindMethod("getPacketLatency"),
+    ]
+
     num_rows = Param.Int(0, "number of rows if 2D (mesh/torus/..) topology");
     ni_flit_size = Param.UInt32(16, "network interface flit size in bytes")
     vcs_per_vnet = Param.UInt32(4, "virtual channels per virtual network");
@@ -0,0 +1,59 @@
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.objects.PowerModelState import PowerModelState
+
+# Per-event energies are in Joules, normally filled in from DSENT by
+# create_power_models() in configs/network/Network.py.
+class GarnetPowerModel(PowerModelState):
+    type = 'GarnetPowerModel'
+    cxx_class = 'NetworkPowerModel'
+    cxx_header = "mem/ruby/network/garnet2.0/NetworkPowerModel.hh"
+    abstract = True
+
+    static_power = Param.Float(0.0, "Leakage power (W)")
+
+class GarnetRouterPowerModel(GarnetPowerModel):
+    type = 'GarnetRouterPowerModel'
+    cxx_class = 'RouterPowerModel'
+    cxx_header = "mem/ruby/network/garnet2.0/NetworkPowerModel.hh"
+
+    buffer_read_energy = Param.Float(0.0, "Energy per input buffer read")
+    buffer_write_energy = Param.Float(0.0, "Energy per input buffer write")
+    sw_input_arbiter_energy = Param.Float(0.0,
+        "Energy per switch allocation at an input port")
+    sw_output_arbiter_energy = Param.Float(0.0,
+        "Energy per switch allocation at an output port")
+    crossbar_energy = Param.Float(0.0, "Energy per crossbar traversal")
+    clock_energy = Param.Float(0.0, "Clock tree energy per cycle")
+
+class GarnetLinkPowerModel(GarnetPowerModel):
+    type = 'GarnetLinkPowerModel'
+    cxx_class = 'LinkPowerModel'
+    cxx_header = "mem/ruby/network/garnet2.0/NetworkPowerModel.hh"
+
+    traversal_energy = Param.Float(0.0, "Energy per flit traversal")
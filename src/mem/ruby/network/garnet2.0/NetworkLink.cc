@@ -33,6 +33,7 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 
+#include "base/logging.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
 
 NetworkLink::NetworkLink(const Params *p)
@@ -40,6 +41,7 @@ NetworkLink::NetworkLink(const Params *p)
       m_type(NUM_LINK_TYPES_),
       m_latency(p->link_latency),
       linkBuffer(new flitBuffer()), link_consumer(nullptr),
+      m_wake_consumer(true), m_boundary(false),
       link_srcQueue(nullptr), m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
@@ -51,9 +53,25 @@ NetworkLink::~NetworkLink()
 }
 
 void
-NetworkLink::setLinkConsumer(Consumer *consumer)
+NetworkLink::setLinkConsumer(Consumer *consumer, bool wake_consumer)
 {
     link_consumer = consumer;
+    m_wake_consumer = wake_consumer;
+    m_boundary = consumer->consumerEventQueue() != eventQueue();
+}
+
+void
+NetworkLink::init()
+{
+    ClockedObject::init();
+
+    // A flit sent over a boundary link is read by the consumer's thread
+    // m_latency cycles later. That has to be in a later quantum, or the
+    // consumer may already have simulated past it.
+    fatal_if(m_boundary && clockPeriod() * m_latency < simQuantum,
+             "%s crosses event queues but its latency (%d cycles) is "
+             "shorter than the simulation quantum (%d ticks)\n",
+             name(), m_latency, simQuantum);
 }
 
 void
@@ -68,13 +86,38 @@ NetworkLink::wakeup()
     if (link_srcQueue->isReady(curCycle())) {
         flit *t_flit = link_srcQueue->getTopFlit();
         t_flit->set_time(curCycle() + m_latency);
-        linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
+
+        // The flit may belong to the consumer's thread once inserted.
+        {
+            auto lock = lockBuffer();
+            linkBuffer->insert(t_flit);
+        }
+
+        if (m_wake_consumer)
+            wakeConsumer(clockEdge(m_latency));
     }
 }
 
+void
+NetworkLink::wakeConsumer(Tick when)
+{
+    if (!m_boundary) {
+        link_consumer->scheduleEventAbsolute(when);
+        return;
+    }
+
+    // The consumer's wakeup bookkeeping belongs to its own thread, so
+    // post an event to its queue that does the scheduling there.
+    Consumer *consumer = link_consumer;
+    consumer->consumerEventQueue()->schedule(
+        new EventFunctionWrapper(
+            [consumer, when]{ consumer->scheduleEventAbsolute(when); },
+            "NetworkLink boundary wakeup", true),
+        when);
+}
+
 void
 NetworkLink::resetStats()
 {
@@ -100,5 +143,6 @@ CreditLinkParams::create()
 uint32_t
 NetworkLink::functionalWrite(Packet *pkt)
 {
+    auto lock = lockBuffer();
     return linkBuffer->functionalWrite(pkt);
 }
@@ -35,6 +35,7 @@
 #define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKLINK_HH__
 
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -52,7 +53,12 @@ class NetworkLink : public ClockedObject, public Consumer
     NetworkLink(const Params *p);
     ~NetworkLink();
 
-    void setLinkConsumer(Consumer *consumer);
+    void init();
+
+    // A consumer that polls the link whenever it wakes up for other
+    // reasons (see Router::addOutPort) can ask not to be scheduled for
+    // every flit that arrives.
+    void setLinkConsumer(Consumer *consumer, bool wake_consumer = true);
     void setSourceQueue(flitBuffer *srcQueue);
     void setType(link_type type) { m_type = type; }
     link_type getType() { return m_type; }
@@ -64,21 +70,40 @@ class NetworkLink : public ClockedObject, public Consumer
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
 
     inline bool isReady(Cycles curTime)
-    { return linkBuffer->isReady(curTime); }
+    { auto lock = lockBuffer(); return linkBuffer->isReady(curTime); }
 
-    inline flit* peekLink()       { return linkBuffer->peekTopFlit(); }
-    inline flit* consumeLink()    { return linkBuffer->getTopFlit(); }
+    inline flit* peekLink()
+    { auto lock = lockBuffer(); return linkBuffer->peekTopFlit(); }
+    inline flit* consumeLink()
+    { auto lock = lockBuffer(); return linkBuffer->getTopFlit(); }
 
     uint32_t functionalWrite(Packet *);
     void resetStats();
 
   private:
+    // A link whose consumer runs on another event queue is written by
+    // this queue's thread and read by the consumer's, so its buffer is
+    // locked. Links within a partition skip the lock.
+    std::unique_lock<std::mutex>
+    lockBuffer()
+    {
+        return m_boundary ? std::unique_lock<std::mutex>(m_buffer_mutex)
+                          : std::unique_lock<std::mutex>();
+    }
+
+    void wakeConsumer(Tick when);
+
     const int m_id;
     link_type m_type;
     const Cycles m_latency;
 
     flitBuffer *linkBuffer;
     Consumer *link_consumer;
+    bool m_wake_consumer;
+
+    // Set if the consumer is on a different event queue, see lockBuffer()
+    bool m_boundary;
+    std::mutex m_buffer_mutex;
     flitBuffer *link_srcQueue;
 
     // Statistical variables
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet2.0/NetworkPowerModel.hh"
+
+#include "base/logging.hh"
+#include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/Router.hh"
+#include "sim/core.hh"
+
+NetworkPowerModel::NetworkPowerModel(const Params *p)
+    : PowerModelState(p), m_static_power(p->static_power),
+      m_reset_tick(0)
+{
+}
+
+double
+NetworkPowerModel::getDynamicPower() const
+{
+    Tick now = curTick();
+    if (now == m_reset_tick)
+        return 0;
+
+    return dynamicEnergy() / ((now - m_reset_tick) / SimClock::Float::s);
+}
+
+void
+NetworkPowerModel::resetStats()
+{
+    PowerModelState::resetStats();
+
+    // The activity counters restart from zero with the stats
+    m_reset_tick = curTick();
+}
+
+RouterPowerModel::RouterPowerModel(const Params *p)
+    : NetworkPowerModel(p), m_router(nullptr),
+      m_buffer_read_energy(p->buffer_read_energy),
+      m_buffer_write_energy(p->buffer_write_energy),
+      m_sw_input_arbiter_energy(p->sw_input_arbiter_energy),
+      m_sw_output_arbiter_energy(p->sw_output_arbiter_energy),
+      m_crossbar_energy(p->crossbar_energy),
+      m_clock_energy(p->clock_energy), m_reset_cycle(0)
+{
+}
+
+void
+RouterPowerModel::init()
+{
+    NetworkPowerModel::init();
+
+    m_router = dynamic_cast<Router *>(clocked_object);
+    fatal_if(!m_router, "%s belongs to %s, which is not a garnet router\n",
+             name(), clocked_object ? clocked_object->name() : "nothing");
+}
+
+void
+RouterPowerModel::resetStats()
+{
+    NetworkPowerModel::resetStats();
+
+    m_reset_cycle = m_router->curCycle();
+}
+
+double
+RouterPowerModel::dynamicEnergy() const
+{
+    return m_router->get_buf_read_activity() * m_buffer_read_energy +
+        m_router->get_buf_write_activity() * m_buffer_write_energy +
+        m_router->get_sw_input_arbiter_activity() *
+            m_sw_input_arbiter_energy +
+        m_router->get_sw_output_arbiter_activity() *
+            m_sw_output_arbiter_energy +
+        m_router->get_crossbar_activity() * m_crossbar_energy +
+        (m_router->curCycle() - m_reset_cycle) * m_clock_energy;
+}
+
+LinkPowerModel::LinkPowerModel(const Params *p)
+    : NetworkPowerModel(p), m_link(nullptr),
+      m_traversal_energy(p->traversal_energy)
+{
+}
+
+void
+LinkPowerModel::init()
+{
+    NetworkPowerModel::init();
+
+    m_link = dynamic_cast<NetworkLink *>(clocked_object);
+    fatal_if(!m_link, "%s belongs to %s, which is not a garnet link\n",
+             name(), clocked_object ? clocked_object->name() : "nothing");
+}
+
+double
+LinkPowerModel::dynamicEnergy() const
+{
+    return m_link->getLinkUtilization() * m_traversal_energy;
+}
+
+RouterPowerModel *
+GarnetRouterPowerModelParams::create()
+{
+    return new RouterPowerModel(this);
+}
+
+LinkPowerModel *
+GarnetLinkPowerModelParams::create()
+{
+    return new LinkPowerModel(this);
+}
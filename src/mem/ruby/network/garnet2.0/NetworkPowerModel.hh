@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2019
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_NETWORKPOWERMODEL_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKPOWERMODEL_HH__
+
+#include "base/types.hh"
+#include "params/GarnetLinkPowerModel.hh"
+#include "params/GarnetPowerModel.hh"
+#include "params/GarnetRouterPowerModel.hh"
+#include "sim/power/power_model.hh"
+
+class NetworkLink;
+class Router;
+
+/**
+ * Power model state for a garnet router or link. The energy of each kind
+ * of event is worked out by DSENT when the system is configured (see
+ * configs/network/Network.py), and the model multiplies it with the
+ * activity counters of the router or link while the simulation runs, so
+ * NoC power can feed the thermal model like any other PowerModelState.
+ *
+ * Dynamic power is averaged over the stats interval, that is the time
+ * since the last stats reset, so every caller gets the same answer.
+ */
+class NetworkPowerModel : public PowerModelState
+{
+  public:
+    typedef GarnetPowerModelParams Params;
+    NetworkPowerModel(const Params *p);
+
+    double getDynamicPower() const;
+    double getStaticPower() const { return m_static_power; }
+
+    void resetStats();
+
+  protected:
+    /** Dynamic energy (J) spent since the last stats reset */
+    virtual double dynamicEnergy() const = 0;
+
+  private:
+    const double m_static_power;
+
+    /** When the activity counters last restarted from zero */
+    Tick m_reset_tick;
+};
+
+class RouterPowerModel : public NetworkPowerModel
+{
+  public:
+    typedef GarnetRouterPowerModelParams Params;
+    RouterPowerModel(const Params *p);
+
+    void init();
+    void resetStats();
+
+  protected:
+    double dynamicEnergy() const;
+
+  private:
+    Router *m_router;
+
+    const double m_buffer_read_energy;
+    const double m_buffer_write_energy;
+    const double m_sw_input_arbiter_energy;
+    const double m_sw_output_arbiter_energy;
+    const double m_crossbar_energy;
+    const double m_clock_energy;
+
+    // The clock tree toggles every cycle, busy or not
+    Cycles m_reset_cycle;
+};
+
+class LinkPowerModel : public NetworkPowerModel
+{
+  public:
+    typedef GarnetLinkPowerModelParams Params;
+    LinkPowerModel(const Params *p);
+
+    void init();
+
+  protected:
+    double dynamicEnergy() const;
+
+  private:
+    NetworkLink *m_link;
+
+    const double m_traversal_energy;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_NETWORKPOWERMODEL_HH__
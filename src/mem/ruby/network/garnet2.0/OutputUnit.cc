@@ -127,17 +127,19 @@ OutputUnit::select_free_vc(int vnet)
  * It increments the credit count in the appropriate output VC state.
  * If the credit carries is_free_signal as true,
  * the output VC is marked IDLE.
+ * The credit link does not wake the router, so all credits that arrived
+ * since the last wakeup are applied here, each at its own arrival time.
  */
 
 void
 OutputUnit::wakeup()
 {
-    if (m_credit_link->isReady(m_router->curCycle())) {
+    while (m_credit_link->isReady(m_router->curCycle())) {
         Credit *t_credit = (Credit*) m_credit_link->consumeLink();
         increment_credit(t_credit->get_vc());
 
         if (t_credit->is_free_signal())
-            set_vc_state(IDLE_, t_credit->get_vc(), m_router->curCycle());
+            set_vc_state(IDLE_, t_credit->get_vc(), t_credit->get_time());
 
         delete t_credit;
     }
@@ -136,7 +136,11 @@ Router::addOutPort(PortDirection outport_dirn,
 
     output_unit->set_out_link(out_link);
     output_unit->set_credit_link(credit_link);
-    credit_link->setLinkConsumer(this);
+    // Credits only change the output VC state, which is read by switch
+    // allocation. A router with flits to allocate wakes up every cycle
+    // anyway, and an empty one has nothing to allocate, so credits are
+    // picked up by the next wakeup rather than waking the router.
+    credit_link->setLinkConsumer(this, false);
     out_link->setSourceQueue(output_unit->getOutQueue());
 
     m_output_unit.push_back(output_unit);
@@ -221,16 +225,12 @@ Router::regStats()
 void
 Router::collateStats()
 {
-    for (int j = 0; j < m_virtual_networks; j++) {
-        for (int i = 0; i < m_input_unit.size(); i++) {
-            m_buffer_reads += m_input_unit[i]->get_buf_read_activity(j);
-            m_buffer_writes += m_input_unit[i]->get_buf_write_activity(j);
-        }
-    }
+    m_buffer_reads += get_buf_read_activity();
+    m_buffer_writes += get_buf_write_activity();
 
-    m_sw_input_arbiter_activity = m_sw_alloc->get_input_arbiter_activity();
-    m_sw_output_arbiter_activity = m_sw_alloc->get_output_arbiter_activity();
-    m_crossbar_activity = m_switch->get_crossbar_activity();
+    m_sw_input_arbiter_activity = get_sw_input_arbiter_activity();
+    m_sw_output_arbiter_activity = get_sw_output_arbiter_activity();
+    m_crossbar_activity = get_crossbar_activity();
 }
 
 void
@@ -246,6 +246,48 @@ Router::resetStats()
     m_sw_alloc->resetStats();
 }
 
+double
+Router::get_buf_read_activity()
+{
+    double reads = 0;
+    for (int j = 0; j < m_virtual_networks; j++) {
+        for (int i = 0; i < m_input_unit.size(); i++) {
+            reads += m_input_unit[i]->get_buf_read_activity(j);
+        }
+    }
+    return reads;
+}
+
+double
+Router::get_buf_write_activity()
+{
+    double writes = 0;
+    for (int j = 0; j < m_virtual_networks; j++) {
+        for (int i = 0; i < m_input_unit.size(); i++) {
+            writes += m_input_unit[i]->get_buf_write_activity(j);
+        }
+    }
+    return writes;
+}
+
+double
+Router::get_sw_input_arbiter_activity()
+{
+    return m_sw_alloc->get_input_arbiter_activity();
+}
+
+double
+Router::get_sw_output_arbiter_activity()
+{
+    return m_sw_alloc->get_output_arbiter_activity();
+}
+
+double
+Router::get_crossbar_activity()
+{
+    return m_switch->get_crossbar_activity();
+}
+
 void
 Router::printFaultVector(ostream& out)
 {
@@ -103,6 +103,13 @@ class Router : public BasicRouter, public Consumer
     void collateStats();
     void resetStats();
 
+    // Activity since the last stats reset, read live by RouterPowerModel
+    double get_buf_read_activity();
+    double get_buf_write_activity();
+    double get_sw_input_arbiter_activity();
+    double get_sw_output_arbiter_activity();
+    double get_crossbar_activity();
+
     // For Fault Model:
     bool get_fault_vector(int temperature, float fault_vector[]) {
         return m_network_ptr->fault_model->fault_vector(m_id, temperature,
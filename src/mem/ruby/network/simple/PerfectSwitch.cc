@@ -195,7 +195,7 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
         for (int i = 0; i < m_routing_table.size(); i++) {
             // pick the next link to look at
             int link = m_link_order[i].m_link;
-            NetDest dst = m_routing_table[link];
+            const NetDest &dst = m_routing_table[link];
             DPRINTF(RubyNetwork, "dst: %s\n", dst);
 
             if (!msg_dsts.intersectionIsNotEmpty(dst))
@@ -138,7 +138,7 @@ Profiler::regStats(const std::string &pName)
         .flags(Stats::nozero | Stats::pdf | Stats::oneline);
 
     m_latencyHistSeqr
-        .init(10)
+        .init(Sequencer::maxLatencyHistValue)
         .name(pName + ".latency_hist_seqr")
         .desc("")
         .flags(Stats::nozero | Stats::pdf | Stats::oneline);
@@ -150,13 +150,13 @@ Profiler::regStats(const std::string &pName)
         .flags(Stats::nozero | Stats::pdf | Stats::oneline);
 
     m_hitLatencyHistSeqr
-        .init(10)
+        .init(Sequencer::maxLatencyHistValue)
         .name(pName + ".hit_latency_hist_seqr")
         .desc("")
         .flags(Stats::nozero | Stats::pdf | Stats::oneline);
 
     m_missLatencyHistSeqr
-        .init(10)
+        .init(Sequencer::maxLatencyHistValue)
         .name(pName + ".miss_latency_hist_seqr")
         .desc("")
         .flags(Stats::nozero | Stats::pdf | Stats::oneline);
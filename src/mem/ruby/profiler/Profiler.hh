@@ -98,14 +98,14 @@ class Profiler
     Stats::Histogram m_outstandReqHistCoalsr;
 
     //! Histogram for holding latency profile of all requests.
-    Stats::Histogram m_latencyHistSeqr;
+    Stats::LogHistogram m_latencyHistSeqr;
     Stats::Histogram m_latencyHistCoalsr;
     std::vector<Stats::Histogram *> m_typeLatencyHistSeqr;
     std::vector<Stats::Histogram *> m_typeLatencyHistCoalsr;
 
     //! Histogram for holding latency profile of all requests that
     //! hit in the controller connected to this sequencer.
-    Stats::Histogram m_hitLatencyHistSeqr;
+    Stats::LogHistogram m_hitLatencyHistSeqr;
     std::vector<Stats::Histogram *> m_hitTypeLatencyHistSeqr;
 
     //! Histograms for profiling the latencies for requests that
@@ -115,7 +115,7 @@ class Profiler
 
     //! Histogram for holding latency profile of all requests that
     //! miss in the controller connected to this sequencer.
-    Stats::Histogram m_missLatencyHistSeqr;
+    Stats::LogHistogram m_missLatencyHistSeqr;
     Stats::Histogram m_missLatencyHistCoalsr;
     std::vector<Stats::Histogram *> m_missTypeLatencyHistSeqr;
     std::vector<Stats::Histogram *> m_missTypeLatencyHistCoalsr;
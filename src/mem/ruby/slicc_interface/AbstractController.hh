@@ -132,6 +132,15 @@ class AbstractController : public ClockedObject, public Consumer
     //! Initialize the message buffers.
     virtual void initNetQueues() = 0;
 
+    //! The transitions taken since the last stats reset, as a row-major
+    //! getNumStates() x getNumEvents() table. Used by RubySystem to dump
+    //! the counts in binary form.
+    virtual int getNumStates() const = 0;
+    virtual int getNumEvents() const = 0;
+    virtual std::string getStateName(int state) const = 0;
+    virtual std::string getEventName(int event) const = 0;
+    virtual const uint64_t *getTransitionCounts() const = 0;
+
     /** A function used to return the port associated with this bus object. */
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID);
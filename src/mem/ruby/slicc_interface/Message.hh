@@ -31,16 +31,72 @@
 
 #include <iostream>
 #include <memory>
+#include <new>
 #include <stack>
 
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/protocol/MessageSizeType.hh"
 #include "mem/ruby/common/NetDest.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
+typedef RefCountingPtr<Message> MsgPtr;
+
+/**
+ * Free list for the storage of the messages of one type. Message types
+ * allocate from it in their operator new, so that the storage of a
+ * message that has been consumed is reused by the next message of the
+ * same type instead of going back to malloc. Storage of any other size,
+ * e.g. of a derived type that does not have its own pool, is passed
+ * through to the global operator new. Like the rest of Ruby, the pools
+ * are not thread safe.
+ */
+template <class T>
+class MessagePool
+{
+  private:
+    struct FreeEntry
+    {
+        FreeEntry *next;
+    };
+
+    static FreeEntry *freeList;
+
+  public:
+    static void *
+    allocate(size_t size)
+    {
+        if (size != sizeof(T) || !freeList)
+            return ::operator new(size);
+
+        FreeEntry *entry = freeList;
+        freeList = entry->next;
+        return entry;
+    }
+
+    static void
+    release(void *p, size_t size)
+    {
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+
+        FreeEntry *entry = static_cast<FreeEntry *>(p);
+        entry->next = freeList;
+        freeList = entry;
+    }
+};
 
-class Message
+template <class T>
+typename MessagePool<T>::FreeEntry *MessagePool<T>::freeList = nullptr;
+
+/**
+ * Base class of all the messages exchanged by Ruby controllers. Messages
+ * are reference counted, the count is not atomic as Ruby runs in a
+ * single thread.
+ */
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -50,7 +106,7 @@ class Message
     { }
 
     Message(const Message &other)
-        : m_time(other.m_time),
+        : RefCounted(), m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
           m_DelayedTicks(other.m_DelayedTicks),
           m_msg_counter(other.m_msg_counter)
@@ -112,6 +168,12 @@ class Message
     // Variables for required network traversal
     int incoming_link;
     int vnet;
+
+    //! Next message stalled on the same line, only used by the
+    //! MessageStallMap holding this message.
+    MsgPtr m_stall_next;
+
+    friend class MessageStallMap;
 };
 
 inline bool
@@ -68,20 +68,14 @@ void
 DirectoryMemory::init()
 {
     m_num_entries = m_size_bytes / RubySystem::getBlockSizeBytes();
-    m_entries = new AbstractEntry*[m_num_entries];
-    for (int i = 0; i < m_num_entries; i++)
-        m_entries[i] = NULL;
 }
 
 DirectoryMemory::~DirectoryMemory()
 {
     // free up all the directory entries
-    for (uint64_t i = 0; i < m_num_entries; i++) {
-        if (m_entries[i] != NULL) {
-            delete m_entries[i];
-        }
-    }
-    delete [] m_entries;
+    m_entries.forEach([](Addr address, AbstractEntry *entry) {
+        delete entry;
+    });
 }
 
 bool
@@ -115,22 +109,19 @@ DirectoryMemory::lookup(Addr address)
     assert(isPresent(address));
     DPRINTF(RubyCache, "Looking up address: %#x\n", address);
 
-    uint64_t idx = mapAddressToLocalIdx(address);
-    assert(idx < m_num_entries);
-    return m_entries[idx];
+    AbstractEntry **entry = m_entries.find(makeLineAddress(address));
+    return entry ? *entry : NULL;
 }
 
 AbstractEntry*
 DirectoryMemory::allocate(Addr address, AbstractEntry *entry)
 {
     assert(isPresent(address));
-    uint64_t idx;
     DPRINTF(RubyCache, "Looking up address: %#x\n", address);
 
-    idx = mapAddressToLocalIdx(address);
-    assert(idx < m_num_entries);
+    assert(mapAddressToLocalIdx(address) < m_num_entries);
     entry->changePermission(AccessPermission_Read_Only);
-    m_entries[idx] = entry;
+    m_entries[makeLineAddress(address)] = entry;
 
     return entry;
 }
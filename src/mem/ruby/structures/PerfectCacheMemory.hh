@@ -29,10 +29,12 @@
 #ifndef __MEM_RUBY_STRUCTURES_PERFECTCACHEMEMORY_HH__
 #define __MEM_RUBY_STRUCTURES_PERFECTCACHEMEMORY_HH__
 
-#include <unordered_map>
+#include <deque>
+#include <vector>
 
 #include "mem/protocol/AccessPermission.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/FlatAddrMap.hh"
 
 template<class ENTRY>
 struct PerfectCacheLineState
@@ -87,8 +89,15 @@ class PerfectCacheMemory
     PerfectCacheMemory(const PerfectCacheMemory& obj);
     PerfectCacheMemory& operator=(const PerfectCacheMemory& obj);
 
+    // Find the state of a line, allocating it if absent
+    PerfectCacheLineState<ENTRY> &lineState(Addr line_address);
+
     // Data Members (m_prefix)
-    std::unordered_map<Addr, PerfectCacheLineState<ENTRY> > m_map;
+    // Maps the address of every line to its index in m_lines. The lines
+    // are kept in a deque so that they do not move as more are added.
+    FlatAddrMap<int> m_map;
+    std::deque<PerfectCacheLineState<ENTRY> > m_lines;
+    std::vector<int> m_free;
 };
 
 template<class ENTRY>
@@ -111,7 +120,7 @@ template<class ENTRY>
 inline bool
 PerfectCacheMemory<ENTRY>::isTagPresent(Addr address) const
 {
-    return m_map.count(makeLineAddress(address)) > 0;
+    return m_map.count(makeLineAddress(address));
 }
 
 template<class ENTRY>
@@ -121,16 +130,37 @@ PerfectCacheMemory<ENTRY>::cacheAvail(Addr address) const
     return true;
 }
 
+template<class ENTRY>
+inline PerfectCacheLineState<ENTRY> &
+PerfectCacheMemory<ENTRY>::lineState(Addr line_address)
+{
+    int *idx = m_map.find(line_address);
+    if (idx)
+        return m_lines[*idx];
+
+    int new_idx;
+    if (m_free.empty()) {
+        new_idx = m_lines.size();
+        m_lines.emplace_back();
+    } else {
+        new_idx = m_free.back();
+        m_free.pop_back();
+        m_lines[new_idx] = PerfectCacheLineState<ENTRY>();
+    }
+    m_map[line_address] = new_idx;
+    return m_lines[new_idx];
+}
+
 // find an Invalid or already allocated entry and sets the tag
 // appropriate for the address
 template<class ENTRY>
 inline void
 PerfectCacheMemory<ENTRY>::allocate(Addr address)
 {
-    PerfectCacheLineState<ENTRY> line_state;
+    PerfectCacheLineState<ENTRY> &line_state =
+        lineState(makeLineAddress(address));
     line_state.m_permission = AccessPermission_Invalid;
     line_state.m_entry = ENTRY();
-    m_map[makeLineAddress(address)] = line_state;
 }
 
 // deallocate entry
@@ -138,7 +168,12 @@ template<class ENTRY>
 inline void
 PerfectCacheMemory<ENTRY>::deallocate(Addr address)
 {
-    m_map.erase(makeLineAddress(address));
+    Addr line_address = makeLineAddress(address);
+    int *idx = m_map.find(line_address);
+    if (idx) {
+        m_free.push_back(*idx);
+        m_map.erase(line_address);
+    }
 }
 
 // Returns with the physical address of the conflicting cache line
@@ -155,7 +190,7 @@ template<class ENTRY>
 inline ENTRY*
 PerfectCacheMemory<ENTRY>::lookup(Addr address)
 {
-    return &m_map[makeLineAddress(address)].m_entry;
+    return &lineState(makeLineAddress(address)).m_entry;
 }
 
 // looks an address up in the cache
@@ -163,14 +198,16 @@ template<class ENTRY>
 inline const ENTRY*
 PerfectCacheMemory<ENTRY>::lookup(Addr address) const
 {
-    return &m_map[makeLineAddress(address)].m_entry;
+    const int *idx = m_map.find(makeLineAddress(address));
+    return idx ? &m_lines[*idx].m_entry : NULL;
 }
 
 template<class ENTRY>
 inline AccessPermission
 PerfectCacheMemory<ENTRY>::getPermission(Addr address) const
 {
-    return m_map[makeLineAddress(address)].m_permission;
+    const int *idx = m_map.find(makeLineAddress(address));
+    return idx ? m_lines[*idx].m_permission : AccessPermission_NotPresent;
 }
 
 template<class ENTRY>
@@ -178,9 +215,7 @@ inline void
 PerfectCacheMemory<ENTRY>::changePermission(Addr address,
                                             AccessPermission new_perm)
 {
-    Addr line_address = makeLineAddress(address);
-    PerfectCacheLineState<ENTRY>& line_state = m_map[line_address];
-    line_state.m_permission = new_perm;
+    lineState(makeLineAddress(address)).m_permission = new_perm;
 }
 
 template<class ENTRY>
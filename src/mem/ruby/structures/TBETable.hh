@@ -30,19 +30,29 @@
 #define __MEM_RUBY_STRUCTURES_TBETABLE_HH__
 
 #include <iostream>
-#include <unordered_map>
+#include <new>
+#include <type_traits>
+#include <vector>
 
+#include "base/logging.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/FlatAddrMap.hh"
 
 template<class ENTRY>
 class TBETable
 {
   public:
     TBETable(int number_of_TBEs)
-        : m_number_of_TBEs(number_of_TBEs)
+        : m_map(number_of_TBEs), m_entries(number_of_TBEs),
+          m_number_of_TBEs(number_of_TBEs)
     {
+        m_free.reserve(number_of_TBEs);
+        for (int i = number_of_TBEs - 1; i >= 0; i--)
+            m_free.push_back(i);
     }
 
+    ~TBETable();
+
     bool isPresent(Addr address) const;
     void allocate(Addr address);
     void deallocate(Addr address);
@@ -62,8 +72,21 @@ class TBETable
     TBETable(const TBETable& obj);
     TBETable& operator=(const TBETable& obj);
 
+    ENTRY *
+    entry(int idx)
+    {
+        return reinterpret_cast<ENTRY *>(&m_entries[idx]);
+    }
+
     // Data Members (m_prefix)
-    std::unordered_map<Addr, ENTRY> m_map;
+    // Maps the address of every allocated TBE to its index in m_entries.
+    // The TBEs themselves never move, SLICC holds pointers to them.
+    FlatAddrMap<int> m_map;
+    // Storage for all the TBEs, they are constructed on allocation.
+    std::vector<typename std::aligned_storage<sizeof(ENTRY),
+                                              alignof(ENTRY)>::type>
+        m_entries;
+    std::vector<int> m_free;
 
   private:
     int m_number_of_TBEs;
@@ -78,13 +101,20 @@ operator<<(std::ostream& out, const TBETable<ENTRY>& obj)
     return out;
 }
 
+template<class ENTRY>
+inline
+TBETable<ENTRY>::~TBETable()
+{
+    m_map.forEach([this](Addr address, int idx) { entry(idx)->~ENTRY(); });
+}
+
 template<class ENTRY>
 inline bool
 TBETable<ENTRY>::isPresent(Addr address) const
 {
     assert(address == makeLineAddress(address));
     assert(m_map.size() <= m_number_of_TBEs);
-    return !!m_map.count(address);
+    return m_map.count(address);
 }
 
 template<class ENTRY>
@@ -92,8 +122,11 @@ inline void
 TBETable<ENTRY>::allocate(Addr address)
 {
     assert(!isPresent(address));
-    assert(m_map.size() < m_number_of_TBEs);
-    m_map[address] = ENTRY();
+    panic_if(m_free.empty(), "No TBE left to allocate for %#x.\n", address);
+    int idx = m_free.back();
+    m_free.pop_back();
+    new (entry(idx)) ENTRY();
+    m_map[address] = idx;
 }
 
 template<class ENTRY>
@@ -102,6 +135,9 @@ TBETable<ENTRY>::deallocate(Addr address)
 {
     assert(isPresent(address));
     assert(m_map.size() > 0);
+    int idx = *m_map.find(address);
+    entry(idx)->~ENTRY();
+    m_free.push_back(idx);
     m_map.erase(address);
 }
 
@@ -110,8 +146,8 @@ template<class ENTRY>
 inline ENTRY*
 TBETable<ENTRY>::lookup(Addr address)
 {
-  if (m_map.find(address) != m_map.end()) return &(m_map.find(address)->second);
-  return NULL;
+    int *idx = m_map.find(address);
+    return idx ? entry(*idx) : NULL;
 }
 
 
@@ -214,8 +214,9 @@ Tick
 RubyPort::PioSlavePort::recvAtomic(PacketPtr pkt)
 {
     RubyPort *ruby_port = static_cast<RubyPort *>(&owner);
-    // Only atomic_noncaching mode supported!
-    if (!ruby_port->system->bypassCaches()) {
+    // Only atomic_noncaching mode supported, unless warming up
+    if (!ruby_port->system->bypassCaches() &&
+        !ruby_port->m_ruby_system->getAtomicWarmup()) {
         panic("Ruby supports atomic accesses only in noncaching mode\n");
     }
 
@@ -304,8 +305,11 @@ Tick
 RubyPort::MemSlavePort::recvAtomic(PacketPtr pkt)
 {
     RubyPort *ruby_port = static_cast<RubyPort *>(&owner);
-    // Only atomic_noncaching mode supported!
-    if (!ruby_port->system->bypassCaches()) {
+    RubySystem *rs = ruby_port->m_ruby_system;
+    // Only atomic_noncaching mode supported, unless the accesses are
+    // only used to warm up the caches
+    bool warmup = !ruby_port->system->bypassCaches();
+    if (warmup && !rs->getAtomicWarmup()) {
         panic("Ruby supports atomic accesses only in noncaching mode\n");
     }
 
@@ -330,18 +334,33 @@ RubyPort::MemSlavePort::recvAtomic(PacketPtr pkt)
                RubySystem::getBlockSizeBytes());
     }
 
+    if (warmup) {
+        return ruby_port->atomicWarmupAccess(pkt);
+    }
+
     // Find appropriate directory for address
     // This assumes that protocols have a Directory machine,
     // which has its memPort hooked up to memory. This can
     // fail for some custom protocols.
     MachineID id = ruby_port->m_controller->mapAddressToMachine(
                     pkt->getAddr(), MachineType_Directory);
-    RubySystem *rs = ruby_port->m_ruby_system;
     AbstractController *directory =
         rs->m_abstract_controls[id.getType()][id.getNum()];
     return directory->recvAtomic(pkt);
 }
 
+Tick
+RubyPort::atomicWarmupAccess(PacketPtr pkt)
+{
+    DPRINTF(RubyPort, "Atomic warm-up access %s for address %#x\n",
+            pkt->cmdString(), pkt->getAddr());
+
+    // The backing store holds the data, so this is all that needs doing
+    // to keep the CPU going. The caches are left as they are.
+    m_ruby_system->getPhysMem()->access(pkt);
+    return 0;
+}
+
 void
 RubyPort::MemSlavePort::addToRetryList()
 {
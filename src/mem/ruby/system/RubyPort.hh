@@ -152,6 +152,16 @@ class RubyPort : public ClockedObject
                   PortID idx=InvalidPortID) override;
 
     virtual RequestStatus makeRequest(PacketPtr pkt) = 0;
+
+    /**
+     * Perform an access made in atomic mode while the RubySystem is
+     * warming up the caches. The access itself goes to the backing
+     * store; sequencers also use it to warm their caches.
+     *
+     * @param pkt Atomic request, turned into its response
+     * @return The latency of the access
+     */
+    virtual Tick atomicWarmupAccess(PacketPtr pkt);
     virtual int outstandingCount() const = 0;
     virtual bool isDeadlockEventScheduled() const = 0;
     virtual void descheduleDeadlockEvent() = 0;
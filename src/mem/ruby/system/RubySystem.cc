@@ -35,6 +35,7 @@
 #include <list>
 
 #include "base/intmath.hh"
+#include "base/output.hh"
 #include "base/statistics.hh"
 #include "debug/RubyCacheTrace.hh"
 #include "debug/RubySystem.hh"
@@ -58,6 +59,7 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params *p)
     : ClockedObject(p), m_access_backing_store(p->access_backing_store),
+      m_atomic_warmup(p->atomic_warmup), m_transition_counts(nullptr),
       m_cache_recorder(NULL)
 {
     m_randomization = p->randomization;
@@ -67,9 +69,20 @@ RubySystem::RubySystem(const Params *p)
     m_block_size_bits = floorLog2(m_block_size_bytes);
     m_memory_size_bits = p->memory_size_bits;
 
+    // Atomic warm-up leaves the data to the backing store, so the caches
+    // only need to hold the right lines in the right states
+    fatal_if(m_atomic_warmup && !m_access_backing_store,
+             "%s: atomic_warmup requires access_backing_store\n", name());
+
     // Resize to the size of different machine types
     m_abstract_controls.resize(MachineType_NUM);
 
+    if (!p->transition_counts_file.empty()) {
+        m_transition_counts = simout.create(p->transition_counts_file, true);
+        m_transition_counts->stream()->write("RTC1", 4);
+        m_transition_names_written.resize(MachineType_NUM, false);
+    }
+
     // Collate the statistics before they are printed.
     Stats::registerDumpCallback(new RubyStatsCallback(this));
     // Create the profiler
@@ -96,6 +109,89 @@ RubySystem::~RubySystem()
 {
     delete m_network;
     delete m_profiler;
+    if (m_transition_counts)
+        simout.close(m_transition_counts);
+}
+
+void
+RubySystem::collateStats()
+{
+    m_profiler->collateStats();
+
+    if (m_transition_counts)
+        dumpTransitionCounts(*m_transition_counts->stream());
+}
+
+template <class T>
+static void
+writeBinary(std::ostream &os, T value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void
+writeBinary(std::ostream &os, const std::string &str)
+{
+    writeBinary<uint16_t>(os, str.size());
+    os.write(str.data(), str.size());
+}
+
+/*
+ * Writes one record of the counts since the last stats reset, in host
+ * byte order:
+ *
+ *   'D', tick (u64), number of controllers (u32), then per controller:
+ *     machine type (string), version (u32),
+ *     names flag (u8), and if set the state names and the event names
+ *       (each a u16 count followed by strings),
+ *     number of nonzero counts (u32), then per count:
+ *       state (u16), event (u16), count (u64)
+ *
+ * Strings are a u16 length followed by the characters. The names of a
+ * machine type are only written with its first controller in the file.
+ */
+void
+RubySystem::dumpTransitionCounts(std::ostream &os)
+{
+    writeBinary<char>(os, 'D');
+    writeBinary<uint64_t>(os, curTick());
+    writeBinary<uint32_t>(os, m_abs_cntrl_vec.size());
+
+    for (auto cntrl : m_abs_cntrl_vec) {
+        const int num_states = cntrl->getNumStates();
+        const int num_events = cntrl->getNumEvents();
+        const uint64_t *counts = cntrl->getTransitionCounts();
+
+        writeBinary(os, MachineType_to_string(cntrl->getType()));
+        writeBinary<uint32_t>(os, cntrl->getVersion());
+
+        bool names = !m_transition_names_written[cntrl->getType()];
+        writeBinary<uint8_t>(os, names);
+        if (names) {
+            writeBinary<uint16_t>(os, num_states);
+            for (int state = 0; state < num_states; state++)
+                writeBinary(os, cntrl->getStateName(state));
+            writeBinary<uint16_t>(os, num_events);
+            for (int event = 0; event < num_events; event++)
+                writeBinary(os, cntrl->getEventName(event));
+            m_transition_names_written[cntrl->getType()] = true;
+        }
+
+        uint32_t nonzero = 0;
+        for (int i = 0; i < num_states * num_events; i++)
+            nonzero += counts[i] != 0;
+        writeBinary<uint32_t>(os, nonzero);
+
+        for (int i = 0; i < num_states * num_events; i++) {
+            if (counts[i] != 0) {
+                writeBinary<uint16_t>(os, i / num_events);
+                writeBinary<uint16_t>(os, i % num_events);
+                writeBinary<uint64_t>(os, counts[i]);
+            }
+        }
+    }
+
+    os.flush();
 }
 
 void
@@ -46,6 +46,7 @@
 
 class Network;
 class AbstractController;
+class OutputStream;
 
 class RubySystem : public ClockedObject
 {
@@ -65,6 +66,7 @@ class RubySystem : public ClockedObject
     SimpleMemory *getPhysMem() { return m_phys_mem; }
     Cycles getStartCycle() { return m_start_cycle; }
     bool getAccessBackingStore() { return m_access_backing_store; }
+    bool getAtomicWarmup() const { return m_atomic_warmup; }
 
     // Public Methods
     Profiler*
@@ -78,7 +80,7 @@ class RubySystem : public ClockedObject
         ClockedObject::regStats();
         m_profiler->regStats(name());
     }
-    void collateStats() { m_profiler->collateStats(); }
+    void collateStats();
     void resetStats() override;
 
     void memWriteback() override;
@@ -117,6 +119,9 @@ class RubySystem : public ClockedObject
                                      uint64_t uncompressed_trace_size);
 
     void processRubyEvent();
+
+    void dumpTransitionCounts(std::ostream &os);
+
   private:
     // configuration parameters
     static bool m_randomization;
@@ -129,11 +134,17 @@ class RubySystem : public ClockedObject
     static bool m_cooldown_enabled;
     SimpleMemory *m_phys_mem;
     const bool m_access_backing_store;
+    const bool m_atomic_warmup;
 
     Network* m_network;
     std::vector<AbstractController *> m_abs_cntrl_vec;
     Cycles m_start_cycle;
 
+    // Binary transition counts, and which machine types have had their
+    // state and event names written to it
+    OutputStream *m_transition_counts;
+    std::vector<bool> m_transition_names_written;
+
   public:
     Profiler* m_profiler;
     CacheRecorder* m_cache_recorder;
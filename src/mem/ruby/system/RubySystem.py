@@ -47,9 +47,15 @@ class RubySystem(ClockedObject):
 
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
+    atomic_warmup = Param.Bool(False, "Accept atomic accesses from the CPUs, \
+        performing them on phys_mem and using them to warm up the caches \
+        (requires access_backing_store)")
 
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
     all_instructions = Param.Bool(False, "")
     num_of_sequencers = Param.Int("")
     number_of_virtual_networks = Param.Unsigned("")
+    transition_counts_file = Param.String("", "Dump the protocol transition "
+        "counts in binary form to this file in the output directory at "
+        "every stats dump (see util/decode_transition_counts.py)")
@@ -70,6 +70,9 @@ Sequencer::Sequencer(const Params *p)
     assert(m_dataCache_ptr != NULL);
 
     m_runningGarnetStandalone = p->garnet_standalone;
+
+    m_atomic_warmup_master_id = m_ruby_system->getAtomicWarmup() ?
+        system->getMasterId(this, "atomic_warmup") : Request::invldMasterId;
 }
 
 Sequencer::~Sequencer()
@@ -452,6 +455,17 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
     assert(curCycle() >= issued_time);
     Cycles total_latency = curCycle() - issued_time;
 
+    // Atomic warm-up requests only exist to bring the line into the
+    // cache. The backing store holds the data and nobody waits for them.
+    if (isAtomicWarmupRequest(pkt)) {
+        DPRINTF(RubySequencer, "atomic warm-up of %#x done\n",
+                request_address);
+        delete srequest;
+        delete pkt;
+        testDrainComplete();
+        return;
+    }
+
     // Profile the latency for all demand accesses.
     recordMissLatency(total_latency, type, mach, externalHit, issued_time,
                       initialRequestTime, forwardRequestTime,
@@ -616,6 +630,57 @@ Sequencer::makeRequest(PacketPtr pkt)
     return RequestStatus_Issued;
 }
 
+Tick
+Sequencer::atomicWarmupAccess(PacketPtr pkt)
+{
+    Addr line_addr = makeLineAddress(pkt->getAddr());
+    bool ifetch = pkt->req->isInstFetch();
+    bool write = pkt->isWrite();
+    CacheMemory *cache = ifetch ? m_instCache_ptr : m_dataCache_ptr;
+    // Every access is charged the latency of a hit in the first level
+    Tick latency = cyclesToTicks(cache->getTagLatency() +
+                                 cache->getDataLatency());
+
+    RubyPort::atomicWarmupAccess(pkt);
+
+    // A hit only has to update the replacement state, which is done
+    // here rather than through the protocol
+    const AbstractCacheEntry *entry = cache->lookup(line_addr);
+    if (entry) {
+        AccessPermission perm = entry->getPermission();
+        if (perm == AccessPermission_Read_Write ||
+            (perm == AccessPermission_Read_Only && !write)) {
+            cache->setMRU(line_addr);
+            m_atomic_warmup_hits++;
+            return latency;
+        }
+    }
+
+    // A miss is sent through the protocol as a whole line read or write,
+    // so that every controller on the way ends up in the state the
+    // access would have left it in. The CPU does not wait for it: it
+    // completes in the background while the CPU carries on, and it is
+    // simply dropped if the sequencer is full or the line is already on
+    // its way.
+    RequestPtr req = std::make_shared<Request>(
+        line_addr, RubySystem::getBlockSizeBytes(),
+        ifetch ? Request::INST_FETCH : 0, m_atomic_warmup_master_id);
+    PacketPtr warm_pkt = new Packet(req,
+        write ? MemCmd::WriteReq : MemCmd::ReadReq);
+    warm_pkt->allocate();
+
+    if (makeRequest(warm_pkt) == RequestStatus_Issued) {
+        DPRINTF(RubySequencer, "atomic warm-up %s of %#x issued\n",
+                write ? "write" : "read", line_addr);
+        m_atomic_warmup_misses++;
+    } else {
+        delete warm_pkt;
+        m_atomic_warmup_dropped++;
+    }
+
+    return latency;
+}
+
 void
 Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
 {
@@ -633,13 +698,13 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
 
     // check if the packet has data as for example prefetch and flush
     // requests do not
-    std::shared_ptr<RubyRequest> msg =
-        std::make_shared<RubyRequest>(clockEdge(), pkt->getAddr(),
-                                      pkt->isFlush() ?
-                                      nullptr : pkt->getPtr<uint8_t>(),
-                                      pkt->getSize(), pc, secondary_type,
-                                      RubyAccessMode_Supervisor, pkt,
-                                      PrefetchBit_No, proc_id, core_id);
+    RefCountingPtr<RubyRequest> msg =
+        new RubyRequest(clockEdge(), pkt->getAddr(),
+                        pkt->isFlush() ?
+                        nullptr : pkt->getPtr<uint8_t>(),
+                        pkt->getSize(), pc, secondary_type,
+                        RubyAccessMode_Supervisor, pkt,
+                        PrefetchBit_No, proc_id, core_id);
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %#x %s\n",
             curTick(), m_version, "Seq", "Begin", "", "",
@@ -722,13 +787,27 @@ Sequencer::regStats()
         .desc("Number of times a load aliased with a pending store")
         .flags(Stats::nozero);
 
+    m_atomic_warmup_hits
+        .name(name() + ".atomic_warmup_hits")
+        .desc("Number of atomic warm-up accesses that hit in the cache")
+        .flags(Stats::nozero);
+    m_atomic_warmup_misses
+        .name(name() + ".atomic_warmup_misses")
+        .desc("Number of atomic warm-up accesses sent through the protocol")
+        .flags(Stats::nozero);
+    m_atomic_warmup_dropped
+        .name(name() + ".atomic_warmup_dropped")
+        .desc("Number of atomic warm-up misses dropped as the sequencer "
+              "was busy")
+        .flags(Stats::nozero);
+
     // These statistical variables are not for display.
     // The profiler will collate these across different
     // sequencers and display those collated statistics.
     m_outstandReqHist.init(10);
-    m_latencyHist.init(10);
-    m_hitLatencyHist.init(10);
-    m_missLatencyHist.init(10);
+    m_latencyHist.init(maxLatencyHistValue);
+    m_hitLatencyHist.init(maxLatencyHistValue);
+    m_missLatencyHist.init(maxLatencyHistValue);
 
     for (int i = 0; i < RubyRequestType_NUM; i++) {
         m_typeLatencyHist.push_back(new Stats::Histogram());
@@ -61,6 +61,12 @@ class Sequencer : public RubyPort
     Sequencer(const Params *);
     ~Sequencer();
 
+    /**
+     * The largest latency, in cycles, that the latency histograms
+     * resolve. Longer latencies are counted as overflows.
+     */
+    static const uint64_t maxLatencyHistValue = 1 << 24;
+
     // Public Methods
     void wakeup(); // Used only for deadlock detection
     void resetStats();
@@ -84,6 +90,7 @@ class Sequencer : public RubyPort
                       const Cycles firstResponseTime = Cycles(0));
 
     RequestStatus makeRequest(PacketPtr pkt);
+    Tick atomicWarmupAccess(PacketPtr pkt) override;
     bool empty() const;
     int outstandingCount() const { return m_outstanding_count; }
 
@@ -104,11 +111,11 @@ class Sequencer : public RubyPort
     void recordRequestType(SequencerRequestType requestType);
     Stats::Histogram& getOutstandReqHist() { return m_outstandReqHist; }
 
-    Stats::Histogram& getLatencyHist() { return m_latencyHist; }
+    Stats::LogHistogram& getLatencyHist() { return m_latencyHist; }
     Stats::Histogram& getTypeLatencyHist(uint32_t t)
     { return *m_typeLatencyHist[t]; }
 
-    Stats::Histogram& getHitLatencyHist() { return m_hitLatencyHist; }
+    Stats::LogHistogram& getHitLatencyHist() { return m_hitLatencyHist; }
     Stats::Histogram& getHitTypeLatencyHist(uint32_t t)
     { return *m_hitTypeLatencyHist[t]; }
 
@@ -118,7 +125,7 @@ class Sequencer : public RubyPort
     Stats::Histogram& getHitTypeMachLatencyHist(uint32_t r, uint32_t t)
     { return *m_hitTypeMachLatencyHist[r][t]; }
 
-    Stats::Histogram& getMissLatencyHist()
+    Stats::LogHistogram& getMissLatencyHist()
     { return m_missLatencyHist; }
     Stats::Histogram& getMissTypeLatencyHist(uint32_t t)
     { return *m_missTypeLatencyHist[t]; }
@@ -168,6 +175,12 @@ class Sequencer : public RubyPort
     RequestStatus insertRequest(PacketPtr pkt, RubyRequestType request_type);
     bool handleLlsc(Addr address, SequencerRequest* request);
 
+    bool isAtomicWarmupRequest(PacketPtr pkt) const
+    {
+        return m_ruby_system->getAtomicWarmup() &&
+            pkt->req->masterId() == m_atomic_warmup_master_id;
+    }
+
     // Private copy constructor and assignment operator
     Sequencer(const Sequencer& obj);
     Sequencer& operator=(const Sequencer& obj);
@@ -203,16 +216,24 @@ class Sequencer : public RubyPort
 
     bool m_runningGarnetStandalone;
 
+    //! Marks the requests issued to warm the caches in atomic mode.
+    MasterID m_atomic_warmup_master_id;
+
+    //! Counters for the atomic accesses used to warm the caches.
+    Stats::Scalar m_atomic_warmup_hits;
+    Stats::Scalar m_atomic_warmup_misses;
+    Stats::Scalar m_atomic_warmup_dropped;
+
     //! Histogram for number of outstanding requests per cycle.
     Stats::Histogram m_outstandReqHist;
 
     //! Histogram for holding latency profile of all requests.
-    Stats::Histogram m_latencyHist;
+    Stats::LogHistogram m_latencyHist;
     std::vector<Stats::Histogram *> m_typeLatencyHist;
 
     //! Histogram for holding latency profile of all requests that
     //! hit in the controller connected to this sequencer.
-    Stats::Histogram m_hitLatencyHist;
+    Stats::LogHistogram m_hitLatencyHist;
     std::vector<Stats::Histogram *> m_hitTypeLatencyHist;
 
     //! Histograms for profiling the latencies for requests that
@@ -222,7 +243,7 @@ class Sequencer : public RubyPort
 
     //! Histogram for holding latency profile of all requests that
     //! miss in the controller connected to this sequencer.
-    Stats::Histogram m_missLatencyHist;
+    Stats::LogHistogram m_missLatencyHist;
     std::vector<Stats::Histogram *> m_missTypeLatencyHist;
 
     //! Histograms for profiling the latencies for requests that
@@ -320,6 +320,12 @@ class $c_ident : public AbstractController
     bool isPossible(${ident}_State state, ${ident}_Event event);
     uint64_t getTransitionCount(${ident}_State state, ${ident}_Event event);
 
+    int getNumStates() const { return ${ident}_State_NUM; }
+    int getNumEvents() const { return ${ident}_Event_NUM; }
+    std::string getStateName(int state) const;
+    std::string getEventName(int event) const;
+    const uint64_t *getTransitionCounts() const { return &m_counters[0][0]; }
+
 private:
 ''')
 
@@ -364,8 +370,46 @@ TransitionResult doTransitionWorker(${ident}_Event event,
         code('''
                                     Addr addr);
 
-int m_counters[${ident}_State_NUM][${ident}_Event_NUM];
-int m_event_counters[${ident}_Event_NUM];
+''')
+
+        # The transition table, see printCSwitch()
+        if self.TBEType != None and self.EntryType != None:
+            code('typedef void (${c_ident}::*ActionFn)('
+                 '${{self.TBEType.c_ident}}*&, '
+                 '${{self.EntryType.c_ident}}*&, Addr);')
+        elif self.TBEType != None:
+            code('typedef void (${c_ident}::*ActionFn)('
+                 '${{self.TBEType.c_ident}}*&, Addr);')
+        elif self.EntryType != None:
+            code('typedef void (${c_ident}::*ActionFn)('
+                 '${{self.EntryType.c_ident}}*&, Addr);')
+        else:
+            code('typedef void (${c_ident}::*ActionFn)(Addr);')
+
+        code('''
+
+enum TransitionNext { NextInvalid, NextSame, NextFixed, NextComputed };
+
+struct TransitionEntry
+{
+    TransitionNext next;
+    ${ident}_State next_state;
+    // Index of the resource check in checkTransitionResources(), 0 if none
+    int guard;
+    bool stall;
+    // The actions are s_transition_actions[first_action, +num_actions)
+    int first_action;
+    int num_actions;
+};
+
+static const ActionFn s_transition_actions[];
+static const TransitionEntry
+    s_transitions[${ident}_State_NUM][${ident}_Event_NUM];
+
+bool checkTransitionResources(int guard, Addr addr);
+
+uint64_t m_counters[${ident}_State_NUM][${ident}_Event_NUM];
+uint64_t m_event_counters[${ident}_Event_NUM];
 bool m_possible[${ident}_State_NUM][${ident}_Event_NUM];
 
 static std::vector<Stats::Vector *> eventVec;
@@ -828,6 +872,18 @@ $c_ident::getEventCount(${ident}_Event event)
     return m_event_counters[event];
 }
 
+std::string
+$c_ident::getStateName(int state) const
+{
+    return ${ident}_State_to_string(${ident}_State(state));
+}
+
+std::string
+$c_ident::getEventName(int event) const
+{
+    return ${ident}_Event_to_string(${ident}_Event(event));
+}
+
 bool
 $c_ident::isPossible(${ident}_State state, ${ident}_Event event)
 {
@@ -1178,8 +1234,6 @@ ${ident}_Controller::wakeup()
 #include "mem/protocol/Types.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
-#define HASH_FUN(state, event)  ((int(state)*${ident}_Event_NUM)+int(event))
-
 #define GET_TRANSITION_COMMENT() (${ident}_transitionComment.str())
 #define CLEAR_TRANSITION_COMMENT() (${ident}_transitionComment.str(""))
 
@@ -1299,33 +1353,81 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
         code('''
                                         Addr addr)
 {
-    switch(HASH_FUN(state, event)) {
+    const TransitionEntry &trans = s_transitions[state][event];
+
+    switch (trans.next) {
+      case NextInvalid:
+        panic("Invalid transition\\n"
+              "%s time: %d addr: %#x event: %s state: %s\\n",
+              name(), curCycle(), addr, event, state);
+      case NextFixed:
+        next_state = trans.next_state;
+        break;
+''')
+        if any(t.nextState.isWildcard() for t in self.transitions):
+            # When * is encountered as an end state of a transition, the
+            # next state is determined by calling the machine-specific
+            # getNextState function. The next state is determined before
+            # any actions of the transition execute, and therefore the next
+            # state calculation cannot depend on any of the transition
+            # actions.
+            code('''
+      case NextComputed:
+        next_state = getNextState(addr);
+        break;
 ''')
+        code('''
+      default:
+        break;
+    }
 
-        # This map will allow suppress generating duplicate code
-        cases = OrderedDict()
+    if (trans.guard && !checkTransitionResources(trans.guard, addr))
+        return TransitionResult_ResourceStall;
 
-        for trans in self.transitions:
-            case_string = "%s_State_%s, %s_Event_%s" % \
-                (self.ident, trans.state.ident, self.ident, trans.event.ident)
-
-            case = self.symtab.codeFormatter()
-            # Only set next_state if it changes
-            if trans.state != trans.nextState:
-                if trans.nextState.isWildcard():
-                    # When * is encountered as an end state of a transition,
-                    # the next state is determined by calling the
-                    # machine-specific getNextState function. The next state
-                    # is determined before any actions of the transition
-                    # execute, and therefore the next state calculation cannot
-                    # depend on any of the transitionactions.
-                    case('next_state = getNextState(addr);')
-                else:
-                    ns_ident = trans.nextState.ident
-                    case('next_state = ${ident}_State_${ns_ident};')
+    if (trans.stall)
+        return TransitionResult_ProtocolStall;
 
-            actions = trans.actions
-            request_types = trans.request_types
+    for (int i = 0; i < trans.num_actions; i++) {
+        ActionFn action = s_transition_actions[trans.first_action + i];
+''')
+        if self.TBEType != None and self.EntryType != None:
+            code('        (this->*action)(m_tbe_ptr, m_cache_entry_ptr, '
+                 'addr);')
+        elif self.TBEType != None:
+            code('        (this->*action)(m_tbe_ptr, addr);')
+        elif self.EntryType != None:
+            code('        (this->*action)(m_cache_entry_ptr, addr);')
+        else:
+            code('        (this->*action)(addr);')
+        code('''
+    }
+
+    return TransitionResult_Valid;
+}
+''')
+
+        # Every transition becomes one entry of a dense [state][event]
+        # table. The resource checks and request type recording of a
+        # transition become a case of checkTransitionResources(), shared
+        # by all transitions with the same checks, and its actions a run
+        # of member function pointers in s_transition_actions, shared by
+        # all transitions with the same actions.
+        guards = OrderedDict()
+        action_runs = OrderedDict()
+        action_list = []
+        entries = {}
+
+        for trans in self.transitions:
+            if trans.state == trans.nextState:
+                next_kind = "NextSame"
+                next_state = "%s_State_NUM" % self.ident
+            elif trans.nextState.isWildcard():
+                next_kind = "NextComputed"
+                next_state = "%s_State_NUM" % self.ident
+            else:
+                next_kind = "NextFixed"
+                next_state = "%s_State_%s" % (self.ident,
+                                              trans.nextState.ident)
 
             # Check for resources
             case_sorter = []
@@ -1333,80 +1435,109 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
             for key,val in res.iteritems():
                 val = '''
 if (!%s.areNSlotsAvailable(%s, clockEdge()))
-    return TransitionResult_ResourceStall;
+    return false;
 ''' % (key.code, val)
                 case_sorter.append(val)
 
             # Check all of the request_types for resource constraints
-            for request_type in request_types:
+            for request_type in trans.request_types:
                 val = '''
 if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
-    return TransitionResult_ResourceStall;
+    return false;
 }
 ''' % (self.ident, request_type.ident)
                 case_sorter.append(val)
 
+            guard_code = self.symtab.codeFormatter()
+
             # Emit the code sequences in a sorted order.  This makes the
             # output deterministic (without this the output order can vary
             # since Map's keys() on a vector of pointers is not deterministic
             for c in sorted(case_sorter):
-                case("$c")
+                guard_code("$c")
 
             # Record access types for this transition
-            for request_type in request_types:
-                case('recordRequestType(${ident}_RequestType_${{request_type.ident}}, addr);')
+            for request_type in trans.request_types:
+                guard_code('recordRequestType('
+                           '${ident}_RequestType_${{request_type.ident}}, '
+                           'addr);')
+
+            guard_code = str(guard_code)
+            guard = 0
+            if guard_code:
+                if guard_code not in guards:
+                    guards[guard_code] = len(guards) + 1
+                guard = guards[guard_code]
 
             # Figure out if we stall
-            stall = False
-            for action in actions:
-                if action.ident == "z_stall":
-                    stall = True
-                    break
-
-            if stall:
-                case('return TransitionResult_ProtocolStall;')
-            else:
-                if self.TBEType != None and self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, m_cache_entry_ptr, addr);')
-                elif self.TBEType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, addr);')
-                elif self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_cache_entry_ptr, addr);')
-                else:
-                    for action in actions:
-                        case('${{action.ident}}(addr);')
-                case('return TransitionResult_Valid;')
-
-            case = str(case)
+            stall = any(a.ident == "z_stall" for a in trans.actions)
 
-            # Look to see if this transition code is unique.
-            if case not in cases:
-                cases[case] = []
+            run = ()
+            if not stall:
+                run = tuple(a.ident for a in trans.actions)
+            if run not in action_runs:
+                action_runs[run] = len(action_list)
+                action_list.extend(run)
 
-            cases[case].append(case_string)
+            entries[(trans.state.ident, trans.event.ident)] = \
+                "{ %s, %s, %d, %s, %d, %d }" % (next_kind, next_state, guard,
+                    "true" if stall else "false", action_runs[run], len(run))
 
-        # Walk through all of the unique code blocks and spit out the
-        # corresponding case statement elements
-        for case,transitions in cases.iteritems():
-            # Iterative over all the multiple transitions that share
-            # the same code
-            for trans in transitions:
-                code('  case HASH_FUN($trans):')
-            code('    $case\n')
+        code('''
 
+bool
+${ident}_Controller::checkTransitionResources(int guard, Addr addr)
+{
+    switch (guard) {
+''')
+        for guard_code,guard in guards.iteritems():
+            code('      case $guard:')
+            code.indent(2)
+            code('$guard_code')
+            code('return true;')
+            code.dedent(2)
         code('''
       default:
-        panic("Invalid transition\\n"
-              "%s time: %d addr: %#x event: %s state: %s\\n",
-              name(), curCycle(), addr, event, state);
+        panic("%s has no resource check %d\\n", name(), guard);
     }
-
-    return TransitionResult_Valid;
 }
+
+const ${ident}_Controller::ActionFn
+${ident}_Controller::s_transition_actions[] = {
+''')
+        code.indent()
+        for action in action_list:
+            code('&${ident}_Controller::$action,')
+        if not action_list:
+            code('nullptr')
+        code.dedent()
+        code('''
+};
+
+// Rows and columns follow the declaration order of the states and events,
+// which is also the order of their enums.
+static_assert(${ident}_State_NUM == ${{len(self.states)}} &&
+              ${ident}_Event_NUM == ${{len(self.events)}},
+              "transition table does not match the enums");
+
+const ${ident}_Controller::TransitionEntry
+${ident}_Controller::s_transitions
+    [${ident}_State_NUM][${ident}_Event_NUM] = {
 ''')
+        invalid = "{ NextInvalid, %s_State_NUM, 0, false, 0, 0 }" % self.ident
+        code.indent()
+        for state in self.states.itervalues():
+            code('// ${{state.ident}}')
+            code('{')
+            code.indent()
+            for event in self.events.itervalues():
+                entry = entries.get((state.ident, event.ident), invalid)
+                code('$entry, // ${{event.ident}}')
+            code.dedent()
+            code('},')
+        code.dedent()
+        code('};')
+
         code.write(path, "%s_Transitions.cc" % self.ident)
 
 
@@ -290,7 +290,20 @@ $klass ${{self.c_ident}}$parent
 MsgPtr
 clone() const
 {
-     return std::shared_ptr<Message>(new ${{self.c_ident}}(*this));
+     return new ${{self.c_ident}}(*this);
+}
+
+// Messages of this type are allocated from their own pool
+static void *
+operator new(size_t size)
+{
+    return MessagePool<${{self.c_ident}}>::allocate(size);
+}
+
+static void
+operator delete(void *p, size_t size)
+{
+    MessagePool<${{self.c_ident}}>::release(p, size);
 }
 ''')
         else:
@@ -105,6 +105,9 @@ def parse_options():
     group("Statistics Options")
     option("--stats-file", metavar="FILE", default="stats.txt",
         help="Sets the output file for statistics [Default: %default]")
+    option("--stats-select", metavar="REGEX", action='append', default=[],
+        help="Only register the stats, or the stats of the SimObjects, " \
+             "whose name matches REGEX. May be given more than once.")
 
     # Configuration Options
     group("Configuration Options")
@@ -133,6 +136,9 @@ def parse_options():
         help="End debug output at TICK")
     option("--debug-file", metavar="FILE", default="cout",
         help="Sets the output file for debug [Default: %default]")
+    option("--debug-binary", action='store_true', default=False,
+        help="Write debug output in a binary format that is faster to " \
+             "log, to be decoded with util/decode_debug_trace.py")
     option("--debug-ignore", metavar="EXPR", action='append', split=':',
         help="Ignore EXPR sim objects")
     option("--remote-gdb-port", type='int', default=7000,
@@ -346,6 +352,8 @@ def main(*args):
 
     # set stats options
     stats.addStatVisitor(options.stats_file)
+    if options.stats_select:
+        stats.setFilter(options.stats_select)
 
     # Disable listeners unless running interactively or explicitly
     # enabled
@@ -400,7 +408,13 @@ def main(*args):
         e = event.create(trace.disable, event.Event.Debug_Enable_Pri)
         event.mainq.schedule(e, options.debug_end)
 
-    trace.output(options.debug_file)
+    if options.debug_binary:
+        if options.debug_file in ("cout", "cerr"):
+            print("--debug-binary needs a --debug-file", file=sys.stderr)
+            sys.exit(1)
+        trace.binaryOutput(options.debug_file)
+    else:
+        trace.output(options.debug_file)
 
     for ignore in options.debug_ignore:
         _check_tracing()
@@ -347,10 +347,12 @@ def fork(simout="%(parent)s.f%(fork_seq)i"):
         raise RuntimeError("Can not fork a simulator with listeners enabled")
 
     drain()
+    stats.preFork()
 
     try:
         pid = os.fork()
     except OSError as e:
+        stats.postFork(False)
         raise e
 
     if pid == 0:
@@ -365,7 +367,9 @@ def fork(simout="%(parent)s.f%(fork_seq)i"):
                 "pid" : os.getpid(),
                 }
         _m5.core.setOutputDir(options.outdir)
+        stats.postFork(True)
     else:
+        stats.postFork(False)
         fork_count += 1
 
     return pid
@@ -106,24 +106,82 @@ def _url_factory(func):
     return wrapper
 
 @_url_factory
-def _textFactory(fn, desc=True):
+def _textFactory(fn, desc=True, queue=0):
     """Output stats in text format.
 
     Text stat files contain one stat per line with an optional
     description. The description is enabled by default, but can be
     disabled by setting the desc parameter to False.
 
-    Example: text://stats.txt?desc=False
+    Setting the queue parameter to a positive number formats and
+    writes dumps on a background thread, so that the simulation
+    carries on while a dump is written. Up to queue dumps may wait to
+    be written before a dump blocks. The file is complete once the
+    simulator exits.
+
+    Example: text://stats.txt?desc=False&queue=4
+
+    """
+
+    return _m5.stats.initText(fn, desc, queue)
+
+@_url_factory
+def _shmFactory(name, select="", interval=0, samples=1024):
+    """Publish stats to shared memory for a live viewer.
+
+    The stats are written to a ring of samples in the POSIX shared
+    memory object /name, and a control socket name.sock is created in
+    the output directory. util/live_stats.py reads them as the
+    simulation runs. See base/stats/shm.hh for the layout.
+
+    Only the stats matching select are published, which is a colon
+    separated list of stat names where * matches any part of a name,
+    for example to follow the power and temperature of some objects.
+    Stats are published at every dump, and every interval ticks when
+    interval is set. The ring keeps the last samples samples.
+
+    Example: shm://gem5?select='sim_insts:system.cpu.*'&interval=10000000
+
+    """
+
+    output = _m5.stats.initSharedMemory(
+        name, select.split(":") if select else [], samples, interval)
+    _m5.stats.periodicStatSample(output)
+    return output
+
+@_url_factory
+def _historyFactory(fn, select="", interval=0, samples=1024):
+    """Keep a history of stats in memory, and write it out at exit.
+
+    A sample of the stats matching select, a colon separated list of
+    stat names where * matches any part of a name, is taken every
+    interval ticks. Each sample holds how much every counter changed
+    since the previous one, and the value of formulas and means at the
+    time it was taken. The last samples samples are kept, and written
+    to fn with a column per sample when the simulator exits.
+
+    addStatVisitor returns the output, whose history can be read while
+    the simulation runs, for example to detect phases on-line:
+
+      h = m5.stats.addStatVisitor(
+          "history://history.txt?select='system.cpu'&interval=1000000000")
+      ...
+      insts = h.series("system.cpu.committedInsts")
 
     """
 
-    return _m5.stats.initText(fn, desc)
+    output = _m5.stats.initHistory(
+        fn, select.split(":") if select else [], samples, interval)
+    _m5.stats.periodicStatSample(output)
+    return output
 
 factories = {
     # Default to the text factory if we're given a naked path
     "" : _textFactory,
     "file" : _textFactory,
     "text" : _textFactory,
+    "shm" : _shmFactory,
+    "history" : _historyFactory,
 }
 
 def addStatVisitor(url):
@@ -135,7 +193,7 @@ def addStatVisitor(url):
     The available formats are listed in the factories list. Factories
     are called with the path as the first positional parameter and the
     parameters are keyword arguments. Parameter values must be valid
-    Python literals.
+    Python literals. The new output is returned.
 
     """
 
@@ -152,12 +210,40 @@ def addStatVisitor(url):
     except KeyError:
         fatal("Illegal stat file type specified.")
 
-    outputList.append(factory(parsed))
+    output = factory(parsed)
+    outputList.append(output)
+    return output
+
+def preFork():
+    '''Get the outputs ready for the simulator to fork. Pending dumps
+    are written out and the threads of the outputs are stopped.'''
+
+    for output in outputList:
+        output.preFork()
+
+def postFork(child):
+    '''Restart the outputs after the simulator forked. This has to be
+    called once the child has its new output directory.'''
+
+    for output in outputList:
+        output.postFork(child)
 
 def initSimStats():
     _m5.stats.initSimStats()
     _m5.stats.registerPythonStatsHandlers()
 
+def setFilter(patterns):
+    '''Only register the stats selected by patterns, a list of regular
+    expressions. A pattern selects the stats whose name it matches, and
+    all of the stats of the SimObjects whose path it matches. The other
+    stats are never given storage or dumped, and neither are formulas
+    that read a vector or distribution among them. This has to be called
+    before the stats are registered by m5.instantiate().'''
+
+    if isinstance(patterns, str):
+        patterns = [ patterns ]
+    _m5.stats.setFilter(list(patterns))
+
 names = []
 stats_dict = {}
 stats_list = []
@@ -167,6 +253,7 @@ def enable():
     the package is enabled, no more statistics can be created.'''
 
     global stats_list
+    _m5.stats.removeFiltered()
     stats_list = list(_m5.stats.statsList())
 
     for stat in stats_list:
@@ -222,16 +309,17 @@ def reset():
     if root:
         for obj in root.descendants(): obj.resetStats()
 
-    # call any other registered stats reset callbacks
-    for stat in stats_list:
-        stat.reset()
+    # reset the storage of every stat, lazily
+    _m5.stats.resetAll()
 
+    # call any other registered stats reset callbacks
     _m5.stats.processResetQueue()
 
 flags = attrdict({
     'none'    : 0x0000,
     'init'    : 0x0001,
     'display' : 0x0002,
+    'filtered': 0x0004,
     'total'   : 0x0010,
     'pdf'     : 0x0020,
     'cdf'     : 0x0040,
@@ -30,4 +30,4 @@ from __future__ import print_function
 from __future__ import absolute_import
 
 # Export native methods to Python
-from _m5.trace import output, ignore, disable, enable
+from _m5.trace import output, binaryOutput, decode, ignore, disable, enable
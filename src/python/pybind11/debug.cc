@@ -45,10 +45,12 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
+#include <fstream>
 #include <map>
 #include <vector>
 
 #include "base/debug.hh"
+#include "base/logging.hh"
 #include "base/output.hh"
 #include "base/trace.hh"
 #include "sim/debug.hh"
@@ -70,6 +72,31 @@ output(const char *filename)
     Trace::setDebugLogger(new Trace::OstreamLogger(*file_stream->stream()));
 }
 
+static void
+binaryOutput(const char *filename)
+{
+    OutputStream *file_stream = simout.find(filename);
+
+    if (!file_stream)
+        file_stream = simout.create(filename, true, true);
+
+    Trace::setDebugLogger(new Trace::BinaryLogger(*file_stream->stream()));
+}
+
+static void
+decode(const char *in_name, const char *out_name)
+{
+    std::ifstream in(in_name, std::ios::binary);
+    if (!in)
+        fatal("Can't open binary trace %s\n", in_name);
+
+    std::ofstream out(out_name);
+    if (!out)
+        fatal("Can't open %s\n", out_name);
+
+    Trace::decodeBinaryTrace(in, out);
+}
+
 static void
 ignore(const char *expr)
 {
@@ -112,6 +139,8 @@ pybind_init_debug(py::module &m_native)
     py::module m_trace = m_native.def_submodule("trace");
     m_trace
         .def("output", &output)
+        .def("binaryOutput", &binaryOutput)
+        .def("decode", &decode)
         .def("ignore", &ignore)
         .def("enable", &Trace::enable)
         .def("disable", &Trace::disable)
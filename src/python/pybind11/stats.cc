@@ -45,6 +45,8 @@
 #include "pybind11/stl.h"
 
 #include "base/statistics.hh"
+#include "base/stats/history.hh"
+#include "base/stats/shm.hh"
 #include "base/stats/text.hh"
 #include "sim/stat_control.hh"
 #include "sim/stat_register.hh"
@@ -77,22 +79,54 @@ pybind_init_stats(py::module &m_native)
     m
         .def("initSimStats", &Stats::initSimStats)
         .def("initText", &Stats::initText, py::return_value_policy::reference)
+        .def("initSharedMemory", &Stats::initSharedMemory,
+             py::return_value_policy::reference)
+        .def("initHistory", &Stats::initHistory,
+             py::return_value_policy::reference)
         .def("registerPythonStatsHandlers",
              &Stats::registerPythonStatsHandlers)
         .def("schedStatEvent", &Stats::schedStatEvent)
         .def("periodicStatDump", &Stats::periodicStatDump)
+        .def("periodicStatSample", &Stats::periodicStatSample)
         .def("updateEvents", &Stats::updateEvents)
+        .def("resetAll", &Stats::resetAll)
         .def("processResetQueue", &Stats::processResetQueue)
         .def("processDumpQueue", &Stats::processDumpQueue)
         .def("enable", &Stats::enable)
         .def("enabled", &Stats::enabled)
         .def("statsList", &Stats::statsList)
+        .def("setFilter", &Stats::setFilter)
+        .def("removeFiltered", &Stats::removeFiltered)
         ;
 
     py::class_<Stats::Output>(m, "Output")
         .def("begin", &Stats::Output::begin)
         .def("end", &Stats::Output::end)
         .def("valid", &Stats::Output::valid)
+        .def("preFork", &Stats::Output::preFork)
+        .def("postFork", &Stats::Output::postFork)
+        ;
+
+    py::class_<Stats::Text, Stats::Output>(m, "Text")
+        .def("setAsync", &Stats::Text::setAsync)
+        .def("drain", &Stats::Text::drain)
+        ;
+
+    py::class_<Stats::Sampler, Stats::Output>(m, "Sampler")
+        .def("sample", &Stats::Sampler::sample)
+        .def("interval", &Stats::Sampler::interval)
+        ;
+
+    py::class_<Stats::SharedMemory, Stats::Sampler>(m, "SharedMemory")
+        ;
+
+    py::class_<Stats::History, Stats::Sampler>(m, "History")
+        .def("size", &Stats::History::size)
+        .def("names", &Stats::History::valueNames)
+        .def("ticks", &Stats::History::ticks)
+        .def("series", &Stats::History::series)
+        .def("window", &Stats::History::window)
+        .def("write", &Stats::History::write)
         ;
 
     py::class_<Stats::Info>(m, "Info")
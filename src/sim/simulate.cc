@@ -38,6 +38,7 @@
 
 #include "base/logging.hh"
 #include "base/pollevent.hh"
+#include "base/statistics.hh"
 #include "base/types.hh"
 #include "sim/async.hh"
 #include "sim/eventq_impl.hh"
@@ -64,8 +65,9 @@ Event *doSimLoop(EventQueue *);
  * repeated until the simulation terminates.
  */
 static void
-thread_loop(EventQueue *queue)
+thread_loop(EventQueue *queue, uint32_t index)
 {
+    Stats::setThreadShard(index);
     while (true) {
         threadBarrier->wait();
         doSimLoop(queue);
@@ -91,11 +93,15 @@ simulate(Tick num_cycles)
     if (!threads_initialized) {
         threadBarrier = new Barrier(numMainEventQueues);
 
+        // each thread updates its own shard of the sharded stats
+        Stats::initShards(numMainEventQueues);
+
         // the main thread (the one we're currently running on)
         // handles queue 0, so we only need to allocate new threads
         // for queues 1..N-1.  We'll call these the "subordinate" threads.
         for (uint32_t i = 1; i < numMainEventQueues; i++) {
-            threads.push_back(new std::thread(thread_loop, mainEventQueue[i]));
+            threads.push_back(
+                new std::thread(thread_loop, mainEventQueue[i], i));
         }
 
         threads_initialized = true;
@@ -51,10 +51,12 @@
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <vector>
 
 #include "base/callback.hh"
 #include "base/hostinfo.hh"
 #include "base/statistics.hh"
+#include "base/stats/sampler.hh"
 #include "base/time.hh"
 #include "cpu/base.hh"
 #include "sim/global_event.hh"
@@ -284,6 +286,46 @@ periodicStatDump(Tick period)
     }
 }
 
+/**
+ * Event to take a sample of the statistics of a sampling output.
+ */
+class StatSampleEvent : public GlobalEvent
+{
+  private:
+    Sampler *output;
+
+  public:
+    StatSampleEvent(Tick _when, Sampler *_output)
+        : GlobalEvent(_when + simQuantum, Stat_Event_Pri, 0), output(_output)
+    {
+    }
+
+    virtual void
+    process()
+    {
+        output->sample();
+        new StatSampleEvent(curTick() + output->interval(), output);
+    }
+
+    const char *description() const { return "GlobalStatSampleEvent"; }
+};
+
+/** Outputs waiting for the simulation to be instantiated */
+std::vector<Sampler *> pendingSamplers;
+bool sampling = false;
+
+void
+periodicStatSample(Sampler *output)
+{
+    if (!output->interval())
+        return;
+
+    if (sampling)
+        new StatSampleEvent(curTick() + output->interval(), output);
+    else
+        pendingSamplers.push_back(output);
+}
+
 void
 updateEvents()
 {
@@ -298,6 +340,13 @@ updateEvents()
         Tick _when = dumpEvent->when();
         dumpEvent->reschedule(_when + curTick());
     }
+
+    if (!sampling) {
+        sampling = true;
+        for (auto *output : pendingSamplers)
+            periodicStatSample(output);
+        pendingSamplers.clear();
+    }
 }
 
 } // namespace Stats
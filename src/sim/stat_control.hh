@@ -61,7 +61,8 @@ void initSimStats();
  * Update the events after resuming from a checkpoint. When resuming from a
  * checkpoint, curTick will be updated, and any already scheduled events can
  * end up scheduled in the past. This function checks if the dumpEvent is
- * scheduled in the past, and reschedules it appropriately.
+ * scheduled in the past, and reschedules it appropriately. It also starts
+ * the periodic samples of the outputs that sample stats.
  */
 void updateEvents();
 
@@ -84,6 +85,16 @@ void schedStatEvent(bool dump, bool reset, Tick when = curTick(),
  * @param period The period at which the dumping should occur.
  */
 void periodicStatDump(Tick period = 0);
+
+class Sampler;
+
+/**
+ * Take a sample of the statistics selected by a sampling output every
+ * output->interval() ticks, starting from when the simulation is
+ * instantiated. Nothing is scheduled if the output has no interval.
+ * @param output The output to take samples for.
+ */
+void periodicStatSample(Sampler *output);
 } // namespace Stats
 
 #endif // __SIM_STAT_CONTROL_HH__
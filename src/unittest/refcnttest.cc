@@ -96,6 +96,14 @@ class TestRC : public RefCounted
 
 typedef RefCountingPtr<TestRC> Ptr;
 
+class DerivedTestRC : public TestRC
+{
+  public:
+    DerivedTestRC(const char *newTag) : TestRC(newTag) {}
+};
+
+typedef RefCountingPtr<DerivedTestRC> DerivedPtr;
+
 } // anonymous namespace
 
 int
@@ -190,5 +198,17 @@ main()
     EXPECT_TRUE(equalTestAPtr != equalTestB);
     EXPECT_TRUE(equalTestAPtr != equalTestBPtr);
 
+    // Construct a Ptr from a Ptr to a derived class.
+    setCase("construction from a derived Ptr");
+    liveChange();
+    DerivedPtr derivedPtr = new DerivedTestRC("derived");
+    EXPECT_EQ(liveChange(), 1);
+    Ptr baseFromDerived = derivedPtr;
+    EXPECT_TRUE(baseFromDerived.get() == derivedPtr.get());
+    derivedPtr = NULL;
+    EXPECT_EQ(liveChange(), 0);
+    baseFromDerived = NULL;
+    EXPECT_EQ(liveChange(), -1);
+
     return UnitTest::printResults();
 }
@@ -30,9 +30,12 @@
 
 #include "pybind11/pybind11.h"
 
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "base/cprintf.hh"
 #include "base/logging.hh"
@@ -103,18 +106,41 @@ struct StatTest
     Histogram h11;
     Histogram h12;
     SparseHistogram sh1;
+    LogHistogram lh1;
+    ShardedScalar ss1;
+    ShardedDistribution sd1;
 
     Vector s19;
     Vector s20;
 
+    Vector fv1;
+    Distribution fd1;
+
     Formula f1;
     Formula f2;
     Formula f3;
     Formula f4;
     Formula f5;
     Formula f6;
+    Formula f7;
+
+    /**
+     * Formulas which are evaluated both through the FormulaProgram they
+     * are compiled to when the stats are enabled, and through the trees
+     * they were built from.
+     */
+    static const int NumCompiled = 9;
+    Formula compiled[NumCompiled];
+    NodePtr compiledTrees[NumCompiled];
+
+    /** The number of checks that failed */
+    int failures;
 
-    void run();
+    StatTest() : failures(0) {}
+
+    void check(bool ok, const string &what);
+    void checkCompiled();
+    int run();
     void init();
 };
 
@@ -135,6 +161,9 @@ StatTest::init()
     cprintf("sizeof(Vector) = %d\n", sizeof(Vector));
     cprintf("sizeof(Distribution) = %d\n", sizeof(Distribution));
 
+    // Select every stat but the Filtered ones, which get no storage.
+    Stats::setFilter({ "(?!Filtered).*" });
+
     s1
         .name("Stat01")
         .desc("this is statistic 1")
@@ -334,6 +363,23 @@ StatTest::init()
         .desc("this is sparse histogram 1")
         ;
 
+    lh1
+        .init(1000000, 4)
+        .name("LogHistogram1")
+        .desc("this is log histogram 1")
+        ;
+
+    ss1
+        .name("ShardedScalar1")
+        .desc("this is sharded scalar 1")
+        ;
+
+    sd1
+        .init(0, 99, 10)
+        .name("ShardedDistribution1")
+        .desc("this is sharded distribution 1")
+        ;
+
     f1
         .name("Formula1")
         .desc("this is formula 1")
@@ -382,6 +428,23 @@ StatTest::init()
         .flags(total |nozero |nonan)
         ;
 
+    fv1
+        .init(1000)
+        .name("FilteredVector1")
+        .desc("this vector is filtered out")
+        ;
+
+    fd1
+        .name("FilteredDistribution1")
+        .init(0, 999, 1)
+        .desc("this distribution is filtered out")
+        ;
+
+    f7
+        .name("Formula7")
+        .desc("this is formula 7, which reads a filtered out vector")
+        ;
+
     f1 = s1 + s2;
     f2 = (-s1) / (-s2) * (-s3 + ULL(100) + s4);
     f3 = sum(s5) * s7;
@@ -389,9 +452,67 @@ StatTest::init()
     f4 += s5[3];
     f5 = constant(1);
     f6 = s19/s20;
+    f7 = s1 + sum(fv1);
+
+    // Broadcast scalars over vectors, operations on vectors of the same
+    // size, whose totals are taken after summing them, sums, negation,
+    // division by zero, and nodes that the program evaluates through a
+    // Call: an Average, a vector element and a Value.
+    const Temp trees[NumCompiled] = {
+        s4 * s7 + s11,
+        s7 - s7 / s4,
+        s19 / s20,
+        -s7 + constant(3),
+        sum(s7) / (s4 - s4),
+        (s7 - s7) / (s2 - s2),
+        s3 * s7 + s5[3] + s17,
+        s5[3],
+        f1 * s7 - sum(s5),
+    };
+    for (int i = 0; i < NumCompiled; i++) {
+        compiled[i] = trees[i];
+        compiledTrees[i] = trees[i].getNodePtr();
+    }
+}
+
+void
+StatTest::check(bool ok, const string &what)
+{
+    if (!ok) {
+        ccprintf(cerr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/** Results are the same if they are equal, or both not a number. */
+static bool
+sameResult(Result a, Result b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
 }
 
 void
+StatTest::checkCompiled()
+{
+    // Like a dump, bring the stats up to date before reading them.
+    for (auto *info : statsList())
+        info->prepare();
+
+    for (int i = 0; i < NumCompiled; i++) {
+        VResult vec;
+        compiled[i].result(vec);
+        const VResult &expected = compiledTrees[i]->result();
+
+        bool same = vec.size() == expected.size();
+        for (size_type j = 0; same && j < vec.size(); j++)
+            same = sameResult(vec[j], expected[j]);
+        check(same, csprintf("result of compiled formula %d", i));
+        check(sameResult(compiled[i].total(), compiledTrees[i]->total()),
+              csprintf("total of compiled formula %d", i));
+    }
+}
+
+int
 StatTest::run()
 {
     s16[1][0] = 1;
@@ -665,11 +786,63 @@ StatTest::run()
         sh1.sample(random() % 10000);
     }
 
+    // A long tail: mostly short latencies, with a few up to ten times
+    // the histogram maximum, which end up in the overflow bucket.
+    for (int i = 0; i < 10000; i++) {
+        lh1.sample(i % 100);
+        if (i % 100 == 0)
+            lh1.sample((Stats::Counter)i * i / 10);
+    }
+
+    // Three threads update the sharded stats at once; each should end
+    // up with exactly three times what one thread adds.
+    const unsigned shards = 3;
+    const int per_shard = 100000;
+    Stats::initShards(shards);
+    auto shard_work = [this, per_shard](unsigned shard) {
+        Stats::setThreadShard(shard);
+        for (int i = 0; i < per_shard; i++) {
+            ss1++;
+            sd1.sample(i % 100);
+        }
+    };
+    vector<thread> threads;
+    for (unsigned shard = 1; shard < shards; shard++)
+        threads.emplace_back(shard_work, shard);
+    shard_work(0);
+    for (auto &t : threads)
+        t.join();
+
+    check(ss1.value() == shards * per_shard,
+          "ShardedScalar1 counts the increments of every thread");
+    auto *sd1_info = dynamic_cast<DistInfo *>(nameMap()[sd1.name()]);
+    sd1_info->prepare();
+    check(sd1_info->data.samples == shards * per_shard,
+          "ShardedDistribution1 counts the samples of every thread");
+
     s19[0] = 1;
     s19[1] = 100000;
     s20[0] = 100000;
     s20[1] = 1;
 
+    // Updating filtered out stats does nothing, so Formula7 is Stat01.
+    for (int i = 0; i < 1000; i++) {
+        fv1[i] += i;
+        fd1.sample(i);
+    }
+    check(f7.total() == s1.value(), "Formula7 is Stat01");
+
+    // The filtered out stats, and Formula7 which reads one of them, were
+    // removed from the list of stats when they were enabled.
+    for (auto *info : statsList()) {
+        check(info->name != fv1.name() && info->name != fd1.name() &&
+              info->name != f7.name(),
+              csprintf("%s is filtered out", info->name));
+    }
+
+    checkCompiled();
+
+    return failures;
 }
 
 static void
@@ -679,7 +852,7 @@ stattest_init_pybind(py::module &m_internal)
 
     m
         .def("stattest_init", []() { __stattest().init(); })
-        .def("stattest_run", []() { __stattest().run(); })
+        .def("stattest_run", []() { return __stattest().run(); })
         ;
 }
 
@@ -1,6 +1,7 @@
 def main():
     from _m5.stattest import stattest_init, stattest_run
     import m5.stats
+    import sys
 
     stattest_init()
 
@@ -14,6 +15,9 @@ def main():
     # Reset to put the stats in a consistent state.
     m5.stats.reset()
 
-    stattest_run()
+    failures = stattest_run()
 
     m5.stats.dump()
+
+    if failures:
+        sys.exit(1)
@@ -0,0 +1,51 @@
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script decodes a debug trace written with --debug-binary to the
+# text gem5 would have written without it. The messages are formatted
+# by the same code as in the simulator, so run it with a gem5 binary
+# rather than on its own:
+#
+#   build/X86/gem5.opt --debug-flags=Cache --debug-binary \
+#       --debug-file=trace.bin configs/example/se.py ...
+#   build/X86/gem5.opt util/decode_debug_trace.py m5out/trace.bin trace.txt
+
+from __future__ import print_function
+
+import sys
+
+from m5 import trace
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: gem5.opt", sys.argv[0],
+              "<binary trace> <text output>", file=sys.stderr)
+        sys.exit(1)
+
+    trace.decode(sys.argv[1], sys.argv[2])
+
+if __name__ == "__m5_main__" or __name__ == "__main__":
+    main()
@@ -0,0 +1,263 @@
+#!/usr/bin/env python2.7
+
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script decodes an instruction trace written by a BinaryExeTracer
+# to the text ExeTracer would have printed with the same Exec debug
+# flags. It assumes that protoc can be run to generate the Python
+# package for the exec trace messages if it hasn't been already.
+
+from __future__ import print_function
+
+import protolib
+import sys
+
+# Import the exec trace proto definitions
+try:
+    import exec_trace_pb2
+except:
+    print("Did not find protobuf exec trace definitions, attempting to "
+          "generate")
+    from subprocess import call
+    error = call(['protoc', '--python_out=util', '--proto_path=src/proto',
+                  'src/proto/exec_trace.proto'])
+    if not error:
+        print("Generated exec trace proto definitions")
+
+        try:
+            import google.protobuf
+        except:
+            print("Please install Python protobuf module")
+            exit(-1)
+
+        import exec_trace_pb2
+    else:
+        print("Failed to import exec trace proto definitions")
+        exit(-1)
+
+Block = exec_trace_pb2.ExecTraceBlock
+
+# Record flags, see cpu/binary_exetrace.hh
+RAN = 1
+MICROOP = 2
+PREDICATE_FALSE = 4
+MEM_VALID = 8
+FETCH_SEQ_VALID = 16
+CP_SEQ_VALID = 32
+
+# Data status values of a Trace::InstRecord
+DATA_INVALID = 0
+DATA_VEC = 5
+DATA_VEC_PRED = 6
+
+class Records(object):
+    """Reads the varints of the records in a block"""
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.pos = 0
+
+    def varint(self):
+        val = 0
+        shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            val |= (byte & 0x7f) << shift
+            if not byte & 0x80:
+                return val
+            shift += 7
+
+    def signed(self):
+        val = self.varint()
+        return (val >> 1) ^ -(val & 1)
+
+class Printer(object):
+    """Prints instructions the way ExeTracerRecord::traceInst does,
+    including the stream state it leaves behind: the integer base stays
+    what the previous line last set, and every line after the first
+    left aligns the micro PC."""
+    def __init__(self, out):
+        self.out = out
+        self.hex = False
+        self.left = False
+
+    def inst(self, fmt, tick, ctx, inst, flags, pc, upc, asid, data_status,
+             data, addr, fetch_seq, cp_seq):
+        line = []
+        if fmt & Block.Ticks:
+            line.append("%7d: " % tick)
+        line.append(ctx.name + " ")
+        if fmt & Block.Asid:
+            line.append("A%d " % asid)
+            self.hex = False
+        if fmt & Block.Thread:
+            line.append(("T%x : " if self.hex else "T%d : ") % ctx.thread_id)
+
+        if inst.HasField('symbol'):
+            line.append("@" + inst.symbol)
+        else:
+            line.append("0x%x" % pc)
+            self.hex = True
+
+        if flags & MICROOP:
+            line.append(("." + ("%-2d" if self.left else "%2d")) % upc)
+            self.hex = False
+        else:
+            line.append("   ")
+
+        line.append(" : ")
+        line.append("%-26s" % inst.disassembly)
+        self.left = True
+
+        if flags & RAN:
+            line.append(" : ")
+            if fmt & Block.OpClass:
+                line.append(inst.op_class + " : ")
+            if fmt & Block.Result and flags & PREDICATE_FALSE:
+                line.append("Predicated False")
+            if fmt & Block.Result and data_status != DATA_INVALID:
+                line.append(data)
+            if fmt & Block.EffAddr and flags & MEM_VALID:
+                line.append(" A=0x%x" % addr)
+                self.hex = True
+            if fmt & Block.FetchSeq and flags & FETCH_SEQ_VALID:
+                line.append("  FetchSeq=%d" % fetch_seq)
+                self.hex = False
+            if fmt & Block.CPSeq and flags & CP_SEQ_VALID:
+                line.append("  CPSeq=%d" % cp_seq)
+                self.hex = False
+            if fmt & Block.Flags:
+                line.append("  flags=(%s)" % inst.flags)
+
+        line.append("\n")
+        self.out.write("".join(line))
+
+def decodeData(records, data_status):
+    if data_status == DATA_VEC:
+        words = [ records.varint() for i in range(records.varint()) ]
+        return " D=0x[%s]" % "_".join("%08x" % w for w in reversed(words))
+    elif data_status == DATA_VEC_PRED:
+        num_bits = records.varint()
+        bits = []
+        for i in range(0, num_bits, 8):
+            byte = records.varint()
+            bits.extend((byte >> j) & 1 for j in range(min(8, num_bits - i)))
+        text = []
+        for i in reversed(range(num_bits)):
+            text.append("1" if bits[i] else "0")
+            if i != 0 and i % 4 == 0:
+                text.append("_")
+        return " D=0b[%s]" % "".join(text)
+    else:
+        return " D=%#018x" % records.varint()
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: ", sys.argv[0], " <protobuf input> <ASCII output>")
+        exit(-1)
+
+    # Open the file in read mode
+    proto_in = protolib.openFileRd(sys.argv[1])
+
+    try:
+        ascii_out = open(sys.argv[2], 'w')
+    except IOError:
+        print("Failed to open ", sys.argv[2], " for writing")
+        exit(-1)
+
+    # Read the magic number in 4-byte Little Endian
+    magic_number = proto_in.read(4)
+
+    if magic_number != b"gem5":
+        print("Unrecognized file", sys.argv[1])
+        exit(-1)
+
+    header = exec_trace_pb2.ExecTraceHeader()
+    protolib.decodeMessage(proto_in, header)
+
+    if header.ver != 0:
+        print("Warning: file version newer than decoder:", header.ver)
+        print("This decoder may not understand how to decode this file")
+
+    printer = Printer(ascii_out)
+    contexts = {}
+    insts = {}
+    num_insts = 0
+
+    block = Block()
+    while protolib.decodeMessage(proto_in, block):
+        for ctx in block.contexts:
+            contexts[ctx.id] = Block.Context()
+            contexts[ctx.id].CopyFrom(ctx)
+        for inst in block.insts:
+            insts[inst.id] = Block.Inst()
+            insts[inst.id].CopyFrom(inst)
+
+        fmt = block.format
+        records = Records(block.records)
+        tick = 0
+        last_pc = {}
+        last_addr = {}
+        for i in range(block.num_records):
+            tick += records.signed()
+            flags = records.varint()
+            ctx_id = records.varint()
+            inst = insts[records.varint()]
+            pc = last_pc.get(ctx_id, 0) + records.signed()
+            last_pc[ctx_id] = pc
+
+            upc = records.varint() if flags & MICROOP else 0
+            asid = records.varint() if fmt & Block.Asid else 0
+
+            data_status = DATA_INVALID
+            data = None
+            addr = fetch_seq = cp_seq = 0
+            if flags & RAN:
+                data_status = records.varint()
+                if data_status != DATA_INVALID:
+                    data = decodeData(records, data_status)
+                if flags & MEM_VALID:
+                    addr = last_addr.get(ctx_id, 0) + records.signed()
+                    last_addr[ctx_id] = addr
+                if flags & FETCH_SEQ_VALID:
+                    fetch_seq = records.varint()
+                if flags & CP_SEQ_VALID:
+                    cp_seq = records.varint()
+
+            printer.inst(fmt, tick, contexts[ctx_id], inst, flags,
+                         pc & 0xffffffffffffffff, upc, asid, data_status,
+                         data, addr & 0xffffffffffffffff, fetch_seq, cp_seq)
+            num_insts += 1
+
+    print("Decoded instructions:", num_insts)
+
+    # We're done
+    ascii_out.close()
+    proto_in.close()
+
+if __name__ == "__main__":
+    main()
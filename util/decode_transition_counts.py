@@ -0,0 +1,92 @@
+#!/usr/bin/env python2.7
+
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script prints the binary protocol transition counts written by
+# RubySystem (the transition_counts_file parameter, or
+# --ruby-transition-counts) in the same state.event form as stats.txt.
+# The format is described in src/mem/ruby/system/RubySystem.cc and
+# assumed to be in the byte order of the host running this script.
+
+from __future__ import print_function
+
+import struct
+import sys
+
+def read(f, fmt):
+    size = struct.calcsize(fmt)
+    data = f.read(size)
+    if len(data) != size:
+        raise EOFError
+    return struct.unpack(fmt, data)
+
+def read_string(f):
+    (length,) = read(f, "=H")
+    return f.read(length).decode()
+
+def read_names(f):
+    (count,) = read(f, "=H")
+    return [ read_string(f) for i in range(count) ]
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: ", sys.argv[0], " <transition counts file>")
+        exit(-1)
+
+    f = open(sys.argv[1], 'rb')
+    if f.read(4) != b"RTC1":
+        print("Not a transition counts file")
+        exit(-1)
+
+    states = {}
+    events = {}
+    while True:
+        try:
+            (tag,) = read(f, "=c")
+        except EOFError:
+            break
+        if tag != b"D":
+            print("Corrupt record")
+            exit(-1)
+
+        tick, num_cntrls = read(f, "=QI")
+        print("---------- Dump at tick %d ----------" % tick)
+        for i in range(num_cntrls):
+            machine = read_string(f)
+            version, has_names = read(f, "=IB")
+            if has_names:
+                states[machine] = read_names(f)
+                events[machine] = read_names(f)
+
+            (num_counts,) = read(f, "=I")
+            for j in range(num_counts):
+                state, event, count = read(f, "=HHQ")
+                print("%s_%d.%s.%s %d" % (machine, version,
+                    states[machine][state], events[machine][event], count))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,139 @@
+#!/usr/bin/env python2.7
+
+# Copyright (c) 2019
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script follows the stats a simulation publishes to shared
+# memory with a shm:// stats output, and prints each new sample as a
+# line of CSV. For example, with a config script that calls
+#
+#   m5.stats.addStatVisitor(
+#       "shm://gem5?select='sim_insts'&interval=1000000000")
+#
+# run this in another terminal while the simulation runs:
+#
+#   util/live_stats.py m5out/gem5.sock
+#
+# The layout of the shared memory is described in base/stats/shm.hh.
+
+from __future__ import print_function
+
+import argparse
+import mmap
+import os
+import socket
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<8sIIIIQQ")
+SAMPLE_HEADER = struct.Struct("<QQ")
+
+class Control(object):
+    """Line based control channel of a shared memory stats output"""
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.buf = b""
+
+    def readline(self):
+        while b"\n" not in self.buf:
+            data = self.sock.recv(4096)
+            if not data:
+                raise EOFError("control socket closed")
+            self.buf += data
+        line, self.buf = self.buf.split(b"\n", 1)
+        return line.decode()
+
+    def command(self, cmd):
+        self.sock.sendall((cmd + "\n").encode())
+        return self.readline()
+
+    def names(self):
+        count = int(self.command("names"))
+        return [ self.readline() for i in range(count) ]
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Print the stats a simulation publishes to shared "
+                    "memory as CSV")
+    parser.add_argument("socket", help="control socket of the output")
+    parser.add_argument("--interval", type=int,
+                        help="change the publishing interval, in ticks")
+    parser.add_argument("--poll", type=float, default=0.1,
+                        help="seconds between polls of the shared memory")
+    args = parser.parse_args()
+
+    control = Control(args.socket)
+    if args.interval:
+        print(control.command("interval %d" % args.interval),
+              file=sys.stderr)
+
+    # The shared memory is created when the stats are first published
+    while True:
+        info = control.command("info").split()
+        fields = dict(zip(info[0::2], info[1::2]))
+        if fields["ready"] == "1":
+            break
+        time.sleep(args.poll)
+
+    names = control.names()
+    shm_file = "/dev/shm" + fields["shm"]
+    with open(shm_file, "rb") as f:
+        shm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    magic, version, num_values, num_samples, sample_size, tick_freq, _ = \
+        HEADER.unpack_from(shm, 0)
+    if magic != b"GEM5SHM\0" or version != 1:
+        print("Unrecognized shared memory", shm_file, file=sys.stderr)
+        sys.exit(1)
+
+    values = struct.Struct("<%dd" % num_values)
+    print(",".join([ "tick" ] + names))
+    sys.stdout.flush()
+
+    next_sample = 0
+    while True:
+        published = HEADER.unpack_from(shm, 0)[-1]
+        # Samples older than the ring have been overwritten
+        next_sample = max(next_sample, published - num_samples)
+        while next_sample < published:
+            offset = HEADER.size + (next_sample % num_samples) * sample_size
+            seq, tick = SAMPLE_HEADER.unpack_from(shm, offset)
+            sample = values.unpack_from(shm, offset + SAMPLE_HEADER.size)
+            # Skip samples that were written while we read them
+            if seq == 2 * next_sample + 2 and \
+               SAMPLE_HEADER.unpack_from(shm, offset)[0] == seq:
+                print(",".join([ str(tick) ] + [ repr(v) for v in sample ]))
+            next_sample += 1
+        sys.stdout.flush()
+
+        if not os.path.exists(args.socket):
+            break
+        time.sleep(args.poll)
+
+if __name__ == "__main__":
+    main()